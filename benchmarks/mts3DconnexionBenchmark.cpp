@@ -0,0 +1,793 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+
+*/
+
+// Benchmarks of the input hot path, without hardware:
+//  - UpdateDataTable: mask, gain and integration of the axes
+//  - MessageHandler: input latched by the Cocoa message handler and
+//    processed by Run, state table Start/UpdateDataTable/Advance
+//  - Readers: GetAxisData and GetPositionCartesian called by 1 to 8
+//    threads while the input is written and processed by two other
+//    threads, checks that no reader gets a torn state and reports the
+//    read latency (throughput per thread is 1 / mean).  The readers never
+//    lock so the total throughput must scale with the number of readers,
+//    checked while there are enough cores for the readers and the two
+//    other threads
+//  - WaitForEvent: osa3Dconnexion decoding of joystick events from a FIFO
+//  - Stream: UDP packet sent to the packet received over loopback, then
+//    packets lost, reordered and duplicated on purpose must be counted
+//    exactly by the receiver
+//  - EndToEnd: packet written by a fake spacenavd to the axes read with
+//    GetAxisData by another component, EndToEndUdp through the stream and
+//    mts3DconnexionReceiver over loopback.  Each packet changes the axes,
+//    the position can't be used since it is integrated at each period
+// Each benchmark runs for several state table history lengths and event
+// rates (0 is as fast as possible).  Results are printed as a table and can
+// be saved as CSV (one line per run) to compare releases.  Heap allocations
+// are counted after the first sample of each run; the hot path must not
+// allocate so the benchmark fails if any run does.
+
+#include <cisstCommon/cmnLogger.h>
+#include <cisstCommon/cmnUnits.h>
+#include <cisstOSAbstraction/osaGetTime.h>
+#include <cisstOSAbstraction/osaSleep.h>
+#include <cisstOSAbstraction/osaThread.h>
+#include <cisstMultiTask/mtsTaskManager.h>
+#include <cisstMultiTask/mtsInterfaceRequired.h>
+#include <cisstMultiTask/mtsFunctionRead.h>
+#include <saw3Dconnexion/mts3Dconnexion.h>
+#include <saw3Dconnexion/osa3Dconnexion.h>
+#include <saw3Dconnexion/osa3DconnexionUdp.h>
+#include <saw3Dconnexion/mts3DconnexionReceiver.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <linux/joystick.h>
+
+// defined in mts3Dconnexion.cpp
+void mts3DconnexionInternalMessageHandler(mts3Dconnexion * instance,
+                                          const vct6 & axis,
+                                          const vctFixedSizeVector<bool, 2> & buttons);
+
+
+// count the heap allocations of all the threads
+static volatile unsigned long Allocations = 0;
+
+static void * Allocate(size_t size)
+{
+    __sync_fetch_and_add(&Allocations, 1UL);
+    void * pointer = malloc(size ? size : 1);
+    if (!pointer) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+#if (__cplusplus >= 201103L)
+void * operator new(size_t size) { return Allocate(size); }
+void * operator new[](size_t size) { return Allocate(size); }
+void operator delete(void * pointer) noexcept { free(pointer); }
+void operator delete[](void * pointer) noexcept { free(pointer); }
+#if (__cplusplus >= 201402L)
+void operator delete(void * pointer, size_t) noexcept { free(pointer); }
+void operator delete[](void * pointer, size_t) noexcept { free(pointer); }
+#endif
+#else
+void * operator new(size_t size) throw(std::bad_alloc) { return Allocate(size); }
+void * operator new[](size_t size) throw(std::bad_alloc) { return Allocate(size); }
+void operator delete(void * pointer) throw() { free(pointer); }
+void operator delete[](void * pointer) throw() { free(pointer); }
+#endif
+
+// expose the protected methods
+class mts3DconnexionBenchmark: public mts3Dconnexion
+{
+ public:
+    mts3DconnexionBenchmark(const mtsTaskPeriodicConstructorArg & arg, bool eventDriven):
+        mts3Dconnexion(arg, eventDriven) {}
+    void Update(void) { UpdateDataTable(); }
+    void Process(void) { ProcessInput(); }
+    void ReadAxes(mtsDoubleVec & axis) const { GetAxisData(axis); }
+    void ReadPosition(prmPositionCartesianGet & position) const { GetPositionCartesian(position); }
+};
+
+
+// statistics of a run, in microseconds
+struct Result
+{
+    std::string Name;
+    size_t History;
+    double Rate;
+    std::vector<double> Samples;
+    unsigned long Allocations;  // after the first sample
+    unsigned long Baseline;
+
+    // preallocate the samples so the benchmark itself doesn't allocate
+    Result(const std::string & name, size_t history, double rate, size_t samples):
+        Name(name), History(history), Rate(rate), Allocations(0), Baseline(0) {
+        Samples.reserve(samples);
+    }
+    // call after each sample
+    void Count(void) {
+        if (Samples.size() == 1) {
+            Baseline = ::Allocations;
+        }
+        Allocations = ::Allocations - Baseline;
+    }
+};
+
+
+static double Percentile(const std::vector<double> & sorted, double percent)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(percent / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+
+static void Report(const Result & result, std::ostream * csv)
+{
+    std::vector<double> sorted(result.Samples);
+    std::sort(sorted.begin(), sorted.end());
+    double mean = 0.0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        mean += sorted[i];
+    }
+    if (!sorted.empty()) {
+        mean /= sorted.size();
+    }
+    std::cout << std::setw(15) << std::left << result.Name << std::right
+              << std::setw(8) << result.History
+              << std::setw(8) << result.Rate
+              << std::setw(8) << sorted.size()
+              << std::fixed << std::setprecision(3)
+              << std::setw(11) << mean
+              << std::setw(11) << Percentile(sorted, 50.0)
+              << std::setw(11) << Percentile(sorted, 90.0)
+              << std::setw(11) << Percentile(sorted, 99.0)
+              << std::setw(11) << (sorted.empty() ? 0.0 : sorted.back())
+              << std::setw(8) << result.Allocations
+              << std::endl;
+    std::cout.unsetf(std::ios_base::floatfield);
+    if (csv) {
+        *csv << result.Name << "," << result.History << "," << result.Rate << ","
+             << sorted.size() << "," << mean << ","
+             << Percentile(sorted, 50.0) << "," << Percentile(sorted, 90.0) << ","
+             << Percentile(sorted, 99.0) << ","
+             << (sorted.empty() ? 0.0 : sorted.back()) << ","
+             << result.Allocations << std::endl;
+    }
+}
+
+
+// wait until the next event is due, rate 0 doesn't wait
+static void Pace(double rate, double & next)
+{
+    if (rate <= 0.0) {
+        return;
+    }
+    double now = osaGetTime();
+    if (next > now) {
+        osaSleep(next - now);
+    }
+    next += 1.0 / rate;
+}
+
+
+// calls are too short to be timed one by one, time batches instead
+enum {BATCH = 100};
+
+static void BenchmarkUpdateDataTable(mts3DconnexionBenchmark & device, Result & result, size_t samples)
+{
+    for (size_t i = 0; i < samples; ++i) {
+        double start = osaGetTime();
+        for (size_t j = 0; j < BATCH; ++j) {
+            device.Update();
+        }
+        result.Samples.push_back((osaGetTime() - start) / BATCH / cmn_us);
+        result.Count();
+    }
+}
+
+
+static void BenchmarkMessageHandler(mts3DconnexionBenchmark & device, Result & result, size_t samples)
+{
+    vct6 axis(1.0);
+    vctFixedSizeVector<bool, 2> buttons(false);
+    for (size_t i = 0; i < samples; ++i) {
+        double start = osaGetTime();
+        for (size_t j = 0; j < BATCH; ++j) {
+            buttons[0] = ((j % 2) == 0);
+            mts3DconnexionInternalMessageHandler(&device, axis, buttons);
+            device.Process();
+        }
+        result.Samples.push_back((osaGetTime() - start) / BATCH / cmn_us);
+        result.Count();
+    }
+}
+
+
+// one thread delivers the input like the Cocoa callbacks, one processes
+// it like Run and the others read the output concurrently
+class ReadersStress
+{
+ public:
+    enum {MAX_READERS = 8};
+
+    ReadersStress(mts3DconnexionBenchmark & device, size_t readers, size_t samples):
+        Device(device), Readers(readers), Samples(samples),
+        Ready(0), Go(false), Done(0), Torn(0) {
+        for (size_t i = 0; i < Readers; ++i) {
+            Latencies[i].reserve(Samples);
+            Axes[i].SetSize(mts3Dconnexion::StateType::NumAxes);
+        }
+    }
+
+    void * Deliver(int CMN_UNUSED(unused)) {
+        vct6 axis;
+        vctFixedSizeVector<bool, 2> buttons(false);
+        for (unsigned int k = 1; Done < Readers; ++k) {
+            // same magnitude on all axes, a torn read mixes two values
+            axis.SetAll(static_cast<double>(k % 300 + 1));
+            mts3DconnexionInternalMessageHandler(&Device, axis, buttons);
+        }
+        return 0;
+    }
+
+    void * Process(int CMN_UNUSED(unused)) {
+        while (Done < Readers) {
+            Device.Process();
+        }
+        return 0;
+    }
+
+    void * Read(int reader) {
+        mtsDoubleVec & axis = Axes[reader];
+        prmPositionCartesianGet position;
+        // warm up, the first read may size the outputs
+        Check(axis, position);
+        __sync_fetch_and_add(&Ready, 1UL);
+        while (!Go) {
+            osaSleep(10.0 * cmn_us);
+        }
+        for (size_t i = 0; i < Samples; ++i) {
+            double start = osaGetTime();
+            for (size_t j = 0; j < BATCH; ++j) {
+                Check(axis, position);
+            }
+            Latencies[reader].push_back((osaGetTime() - start) / BATCH / cmn_us);
+        }
+        __sync_fetch_and_add(&Done, 1UL);
+        return 0;
+    }
+
+    // the axes have the same magnitude and the translations as well since
+    // they are integrated from the same axes
+    void Check(mtsDoubleVec & axis, prmPositionCartesianGet & position) {
+        Device.ReadAxes(axis);
+        for (size_t i = 1; i < axis.size(); ++i) {
+            if (fabs(axis[i]) != fabs(axis[0])) {
+                __sync_fetch_and_add(&Torn, 1UL);
+                break;
+            }
+        }
+        Device.ReadPosition(position);
+        const vct3 & translation = position.Position().Translation();
+        if ((fabs(translation[1]) != fabs(translation[0]))
+            || (fabs(translation[2]) != fabs(translation[0]))) {
+            __sync_fetch_and_add(&Torn, 1UL);
+        }
+    }
+
+    mts3DconnexionBenchmark & Device;
+    size_t Readers;
+    size_t Samples;
+    std::vector<double> Latencies[MAX_READERS];
+    mtsDoubleVec Axes[MAX_READERS];
+    volatile unsigned long Ready;
+    volatile bool Go;
+    volatile unsigned long Done;
+    volatile unsigned long Torn;
+};
+
+
+// returns the total number of reads per second
+static double BenchmarkReaders(mts3DconnexionBenchmark & device, Result & result, size_t readers, size_t samples,
+                               unsigned long & torn)
+{
+    ReadersStress stress(device, readers, samples);
+    osaThread deliver, process;
+    osaThread threads[ReadersStress::MAX_READERS];
+    deliver.Create<ReadersStress, int>(&stress, &ReadersStress::Deliver, 0);
+    process.Create<ReadersStress, int>(&stress, &ReadersStress::Process, 0);
+    for (size_t i = 0; i < readers; ++i) {
+        threads[i].Create<ReadersStress, int>(&stress, &ReadersStress::Read, static_cast<int>(i));
+    }
+    while (stress.Ready < readers) {
+        osaSleep(1.0 * cmn_ms);
+    }
+    result.Baseline = ::Allocations;
+    double start = osaGetTime();
+    stress.Go = true;
+    for (size_t i = 0; i < readers; ++i) {
+        threads[i].Join();
+    }
+    double elapsed = osaGetTime() - start;
+    result.Allocations = ::Allocations - result.Baseline;
+    deliver.Join();
+    process.Join();
+
+    for (size_t i = 0; i < readers; ++i) {
+        result.Samples.insert(result.Samples.end(),
+                              stress.Latencies[i].begin(), stress.Latencies[i].end());
+    }
+    const double throughput = readers * samples * BATCH / elapsed;
+    std::cout << "  " << readers << " readers: "
+              << static_cast<unsigned long>(throughput)
+              << " reads/s, " << stress.Torn << " torn" << std::endl;
+    torn = stress.Torn;
+    return throughput;
+}
+
+
+static bool BenchmarkStream(const std::string & address, Result & result, size_t samples)
+{
+    osa3DconnexionUdp receiver, sender;
+    if ((receiver.OpenReceiver(address) != osa3DconnexionUdp::ESUCCESS)
+        || (sender.OpenSender(address) != osa3DconnexionUdp::ESUCCESS)) {
+        std::cerr << "Failed to open stream on " << address << std::endl;
+        return false;
+    }
+    osa3DconnexionUdp::Packet packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.type = osa3DconnexionUdp::Packet::SAMPLE;
+    osa3DconnexionUdp::Packet received[osa3DconnexionUdp::BUFFERSIZE];
+    double next = osaGetTime();
+    for (size_t i = 0; i < samples; ++i) {
+        Pace(result.Rate, next);
+        double start = osaGetTime();
+        packet.utimestamp = static_cast<long long>(start / cmn_us);
+        packet.axis[0] = static_cast<float>(i);
+        sender.Send(packet);
+        if (receiver.Receive(received, osa3DconnexionUdp::BUFFERSIZE, 1.0) != 1) {
+            std::cerr << "Failed to receive packet " << i << std::endl;
+            return false;
+        }
+        result.Samples.push_back((osaGetTime() - start) / cmn_us);
+        result.Count();
+    }
+    const osa3DconnexionUdp::Statistics & statistics = receiver.GetStatistics();
+    if ((statistics.lost != 0) || (statistics.reordered != 0) || (statistics.duplicated != 0)) {
+        std::cerr << "Unexpected loss or reordering over loopback" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+
+// send blocks of 10 packets with the 4th lost, the 6th and 7th swapped
+// and the 9th duplicated, the receiver must count exactly one of each per
+// block and return the other packets in order
+static bool BenchmarkStreamCounters(const std::string & address, size_t blocks)
+{
+    osa3DconnexionUdp receiver;
+    if (receiver.OpenReceiver(address) != osa3DconnexionUdp::ESUCCESS) {
+        return false;
+    }
+    int fd = socket(PF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in destination;
+    memset(&destination, 0, sizeof(destination));
+    destination.sin_family = AF_INET;
+    destination.sin_port = htons(static_cast<uint16_t>(atoi(address.substr(address.rfind(':') + 1).c_str())));
+    destination.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    const unsigned int order[] = {0, 1, 2, 4, 6, 5, 7, 8, 8, 9};
+    const size_t sent = sizeof(order) / sizeof(order[0]);
+    osa3DconnexionUdp::Packet packet;
+    memset(&packet, 0, sizeof(packet));
+    packet.type = osa3DconnexionUdp::Packet::SAMPLE;
+    osa3DconnexionUdp::Packet received[osa3DconnexionUdp::BUFFERSIZE];
+    unsigned int last = 0;
+    bool ordered = true;
+    size_t count = 0;
+    for (size_t block = 0; block < blocks; ++block) {
+        for (size_t i = 0; i < sent; ++i) {
+            unsigned char buffer[osa3DconnexionUdp::SAMPLESIZE];
+            packet.sequence = static_cast<unsigned int>(10 * block + order[i]);
+            size_t size = osa3DconnexionUdp::Encode(packet, buffer);
+            sendto(fd, buffer, size, 0, reinterpret_cast<struct sockaddr *>(&destination), sizeof(destination));
+        }
+        size_t n;
+        while ((n = receiver.Receive(received, osa3DconnexionUdp::BUFFERSIZE, 0.1)) != 0) {
+            for (size_t i = 0; i < n; ++i) {
+                ordered = ordered && ((count == 0) || (received[i].sequence > last));
+                last = received[i].sequence;
+                ++count;
+            }
+        }
+    }
+    close(fd);
+
+    const osa3DconnexionUdp::Statistics & statistics = receiver.GetStatistics();
+    std::cout << "  stream: " << statistics.received << " received, "
+              << statistics.lost << " lost, " << statistics.reordered << " reordered, "
+              << statistics.duplicated << " duplicated, expected "
+              << blocks << " of each" << std::endl;
+    return ordered
+        && (statistics.received == blocks * sent)
+        && (statistics.lost == blocks)
+        && (statistics.reordered == blocks)
+        && (statistics.duplicated == blocks)
+        && (count == blocks * (sent - 2));
+}
+
+
+static bool BenchmarkWaitForEvent(const std::string & fifo, Result & result, size_t samples)
+{
+    unlink(fifo.c_str());
+    if (mkfifo(fifo.c_str(), 0600) == -1) {
+        std::cerr << "Failed to create " << fifo << std::endl;
+        return false;
+    }
+    osa3Dconnexion device;
+    if (device.Open(fifo) != osa3Dconnexion::ESUCCESS) {
+        std::cerr << "Failed to open " << fifo << std::endl;
+        unlink(fifo.c_str());
+        return false;
+    }
+    int writer = open(fifo.c_str(), O_WRONLY | O_NONBLOCK);
+
+    // time from write to decoded event, one axis event at a time
+    struct js_event event;
+    memset(&event, 0, sizeof(event));
+    event.type = JS_EVENT_AXIS;
+    double next = osaGetTime();
+    bool completed = true;
+    for (size_t i = 0; i < samples; ++i) {
+        Pace(result.Rate, next);
+        event.time = static_cast<unsigned int>(i);
+        event.number = static_cast<unsigned char>(i % 6);
+        event.value = static_cast<short>(i % 350);
+        double start = osaGetTime();
+        if (write(writer, &event, sizeof(event)) != sizeof(event)) {
+            std::cerr << "Failed to write event " << i << std::endl;
+            completed = false;
+            break;
+        }
+        osa3Dconnexion::Event decoded = device.WaitForEvent(1.0);
+        if (decoded.type == osa3Dconnexion::Event::UNKNOWN) {
+            std::cerr << "Failed to decode event " << i << std::endl;
+            completed = false;
+            break;
+        }
+        result.Samples.push_back((osaGetTime() - start) / cmn_us);
+        result.Count();
+    }
+
+    close(writer);
+    device.Close();
+    unlink(fifo.c_str());
+    return completed;
+}
+
+
+static bool BenchmarkEndToEnd(int daemon, mtsFunctionRead & getAxis, Result & result, size_t samples)
+{
+    mtsDoubleVec axis;
+    if (!getAxis(axis).IsOK() || (axis.size() == 0)) {
+        std::cerr << "Failed to read axes" << std::endl;
+        return false;
+    }
+    double last = axis[0];
+
+    // motion packets along X, see osa3DconnexionSpacenav
+    int packet[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    double next = osaGetTime();
+    for (size_t i = 0; i < samples; ++i) {
+        Pace(result.Rate, next);
+        // alternate the value so each packet changes the axes
+        packet[1] = (packet[1] == 1) ? 2 : 1;
+        double start = osaGetTime();
+        if (write(daemon, packet, sizeof(packet)) != sizeof(packet)) {
+            std::cerr << "Failed to write packet" << std::endl;
+            return false;
+        }
+        // spin until the packet has been processed
+        double now = start;
+        do {
+            getAxis(axis);
+            now = osaGetTime();
+        } while ((axis[0] == last) && (now - start < 1.0));
+        if (axis[0] == last) {
+            std::cerr << "Timeout waiting for axes" << std::endl;
+            return false;
+        }
+        last = axis[0];
+        result.Samples.push_back((now - start) / cmn_us);
+        result.Count();
+    }
+    return true;
+}
+
+
+int main(int argc, char ** argv)
+{
+    cmnLogger::SetMask(CMN_LOG_ALLOW_ALL);
+    cmnLogger::AddChannel(std::cerr, CMN_LOG_ALLOW_ERRORS);
+
+    size_t samples = 1000;
+    std::string output;
+    bool readerThread = false;
+    int option;
+    while ((option = getopt(argc, argv, "n:o:rh")) != -1) {
+        switch (option) {
+        case 'n':
+            samples = strtoul(optarg, 0, 10);
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'r':
+            readerThread = true;
+            break;
+        default:
+            std::cerr << "Usage: " << argv[0] << " [-n samples] [-o results.csv] [-r]" << std::endl
+                      << "  -n samples per run (default 1000)" << std::endl
+                      << "  -o save the results as CSV" << std::endl
+                      << "  -r use the reader thread for end to end runs" << std::endl;
+            return (option == 'h') ? 0 : -1;
+        }
+    }
+
+    std::ofstream csvFile;
+    std::ostream * csv = 0;
+    if (!output.empty()) {
+        csvFile.open(output.c_str());
+        if (!csvFile) {
+            std::cerr << "Failed to open " << output << std::endl;
+            return -1;
+        }
+        csvFile << "benchmark,history,rate,samples,mean_us,p50_us,p90_us,p99_us,max_us,allocations" << std::endl;
+        csv = &csvFile;
+    }
+
+    const size_t histories[] = {256, 1024, 8192};
+    const size_t nbHistories = sizeof(histories) / sizeof(histories[0]);
+    const double rates[] = {0.0, 125.0, 1000.0};
+    const size_t nbRates = sizeof(rates) / sizeof(rates[0]);
+
+    // fake spacenavd, each component gets its own connection
+    std::stringstream path;
+    path << "/tmp/saw3DconnexionBenchmark-" << getpid();
+    const std::string socketName = path.str() + ".sock";
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketName.c_str(), sizeof(address.sun_path) - 1);
+    unlink(socketName.c_str());
+    int listener = socket(PF_UNIX, SOCK_STREAM, 0);
+    if ((listener == -1)
+        || (bind(listener, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) == -1)
+        || (listen(listener, nbHistories) == -1)) {
+        std::cerr << "Failed to create " << socketName << std::endl;
+        return -1;
+    }
+
+    mtsComponentManager * manager = mtsComponentManager::GetInstance();
+    mtsComponent * client = new mtsComponent("client");
+    std::vector<mts3DconnexionBenchmark *> devices;
+    std::vector<int> daemons;
+    mtsFunctionRead getAxes[nbHistories];
+
+    // stream of the first component, received by another component
+    std::stringstream port;
+    port << (20000 + getpid() % 20000);
+    const std::string streamAddress = "127.0.0.1:" + port.str();
+    mts3DconnexionReceiver * receiver = new mts3DconnexionReceiver("3DconnexionReceiver", 1.0 * cmn_ms);
+    receiver->Configure(port.str());
+    manager->AddComponent(receiver);
+    mtsFunctionRead getAxisReceived;
+    client->AddInterfaceRequired(receiver->GetName())->AddFunction("GetAxisData", getAxisReceived);
+
+    for (size_t h = 0; h < nbHistories; ++h) {
+        std::stringstream name;
+        name << "3Dconnexion" << histories[h];
+        mtsTaskPeriodicConstructorArg arg;
+        arg.Name = name.str();
+        arg.Period = 1.0 * cmn_ms;
+        arg.IsHardRealTime = false;
+        arg.StateTableSize = histories[h];
+        mts3DconnexionBenchmark * device = new mts3DconnexionBenchmark(arg, true);
+        device->SetReaderThread(readerThread);
+        device->Configure("spacenavd:" + socketName);
+        if (h == 0) {
+            device->SetStreaming(streamAddress);
+        }
+        daemons.push_back(accept(listener, 0, 0));
+        devices.push_back(device);
+        manager->AddComponent(device);
+
+        mtsInterfaceRequired * required = client->AddInterfaceRequired(name.str());
+        required->AddFunction("GetAxisData", getAxes[h]);
+    }
+    manager->AddComponent(client);
+
+    std::cout << std::setw(15) << std::left << "benchmark" << std::right
+              << std::setw(8) << "history" << std::setw(8) << "rate"
+              << std::setw(8) << "samples" << std::setw(11) << "mean(us)"
+              << std::setw(11) << "p50(us)" << std::setw(11) << "p90(us)"
+              << std::setw(11) << "p99(us)" << std::setw(11) << "max(us)"
+              << std::setw(8) << "allocs" << std::endl;
+
+    // components are not running yet, call the hot path directly
+    bool allocated = false;
+    for (size_t h = 0; h < nbHistories; ++h) {
+        Result result("UpdateDataTable", histories[h], 0.0, samples);
+        BenchmarkUpdateDataTable(*devices[h], result, samples);
+        Report(result, csv);
+        allocated = allocated || (result.Allocations != 0);
+    }
+    for (size_t h = 0; h < nbHistories; ++h) {
+        Result result("MessageHandler", histories[h], 0.0, samples);
+        BenchmarkMessageHandler(*devices[h], result, samples);
+        Report(result, csv);
+        allocated = allocated || (result.Allocations != 0);
+    }
+    bool torn = false;
+    bool scaled = true;
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    const size_t readers[] = {1, 2, 4, 8};
+    double single = 0.0;
+    for (size_t r = 0; r < sizeof(readers) / sizeof(readers[0]); ++r) {
+        std::stringstream name;
+        name << "Readers" << readers[r];
+        Result result(name.str(), histories[0], 0.0, readers[r] * samples);
+        unsigned long tornReads;
+        const double throughput = BenchmarkReaders(*devices[0], result, readers[r], samples, tornReads);
+        torn = (tornReads != 0) || torn;
+        Report(result, csv);
+        allocated = allocated || (result.Allocations != 0);
+        if (readers[r] == 1) {
+            single = throughput;
+        } else if ((cores < 2) || (static_cast<long>(readers[r]) + 2 > cores)) {
+            // the readers would share the cores with the writers
+            std::cout << "  " << readers[r] << " readers: scaling not checked, "
+                      << cores << " cores" << std::endl;
+        } else if (throughput < 0.5 * readers[r] * single) {
+            // at least half of the ideal speedup
+            std::cout << "  " << readers[r] << " readers: expected at least "
+                      << static_cast<unsigned long>(0.5 * readers[r] * single)
+                      << " reads/s" << std::endl;
+            scaled = false;
+        }
+    }
+    // the receiver component isn't started yet, use other ports
+    std::stringstream streamPort;
+    streamPort << "127.0.0.1:" << (20001 + getpid() % 20000);
+    bool streamed = true;
+    for (size_t r = 0; r < nbRates; ++r) {
+        Result result("Stream", 0, rates[r], samples);
+        if (BenchmarkStream(streamPort.str(), result, samples)) {
+            Report(result, csv);
+            allocated = allocated || (result.Allocations != 0);
+        } else {
+            streamed = false;
+        }
+    }
+    bool counted = BenchmarkStreamCounters(streamPort.str(), samples / 10 + 1);
+    // runs which fail or stop short
+    bool completed = true;
+    for (size_t r = 0; r < nbRates; ++r) {
+        Result result("WaitForEvent", 0, rates[r], samples);
+        if (BenchmarkWaitForEvent(path.str() + ".js", result, samples)) {
+            Report(result, csv);
+            allocated = allocated || (result.Allocations != 0);
+        } else {
+            completed = false;
+        }
+    }
+
+    // end to end, through the component thread
+    for (size_t h = 0; h < nbHistories; ++h) {
+        manager->Connect(client->GetName(), devices[h]->GetName(),
+                         devices[h]->GetName(), "ProvidesSpaceNavigator");
+    }
+    manager->Connect(client->GetName(), receiver->GetName(),
+                     receiver->GetName(), "ProvidesSpaceNavigator");
+    manager->CreateAll();
+    manager->WaitForStateAll(mtsComponentState::READY, 5.0 * cmn_s);
+    manager->StartAll();
+    manager->WaitForStateAll(mtsComponentState::ACTIVE, 5.0 * cmn_s);
+
+    for (size_t h = 0; h < nbHistories; ++h) {
+        for (size_t r = 0; r < nbRates; ++r) {
+            Result result(readerThread ? "EndToEndReader" : "EndToEnd", histories[h], rates[r], samples);
+            if (BenchmarkEndToEnd(daemons[h], getAxes[h], result, samples)) {
+                Report(result, csv);
+                allocated = allocated || (result.Allocations != 0);
+            } else {
+                completed = false;
+            }
+        }
+    }
+
+    for (size_t r = 0; r < nbRates; ++r) {
+        Result result("EndToEndUdp", histories[0], rates[r], samples);
+        if (BenchmarkEndToEnd(daemons[0], getAxisReceived, result, samples)) {
+            Report(result, csv);
+            allocated = allocated || (result.Allocations != 0);
+        } else {
+            streamed = false;
+        }
+    }
+
+    manager->KillAll();
+    manager->WaitForStateAll(mtsComponentState::FINISHED, 5.0 * cmn_s);
+    manager->Cleanup();
+
+    for (size_t h = 0; h < nbHistories; ++h) {
+        close(daemons[h]);
+    }
+    close(listener);
+    unlink(socketName.c_str());
+    if (allocated) {
+        std::cerr << "Heap allocations in the hot path" << std::endl;
+        return 1;
+    }
+    if (torn) {
+        std::cerr << "Torn reads of the state" << std::endl;
+        return 1;
+    }
+    if (!scaled) {
+        std::cerr << "Read throughput doesn't scale with the number of readers" << std::endl;
+        return 1;
+    }
+    if (!completed) {
+        std::cerr << "Benchmark runs failed" << std::endl;
+        return 1;
+    }
+    if (!streamed) {
+        std::cerr << "Stream runs failed over loopback" << std::endl;
+        return 1;
+    }
+    if (!counted) {
+        std::cerr << "Stream packets lost, reordered or duplicated not counted" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -20,9 +20,18 @@ http://www.cisst.org/cisst/license.txt.
 
 #include <cisstConfig.h>
 #include <cisstVector/vctDynamicVectorTypes.h>
+#include <cisstOSAbstraction/osaGetTime.h>
+#include <cisstOSAbstraction/osaSleep.h>
+#include <cisstOSAbstraction/osaThread.h>
+#include <cisstOSAbstraction/osaMutex.h>
 #include <cisstMultiTask/mtsInterfaceProvided.h>
+#include <cisstMultiTask/mtsQueue.h>
 #include <saw3Dconnexion/mts3Dconnexion.h>
+#include <saw3Dconnexion/mts3DconnexionSnapshot.h>
 #include <saw3DconnexionConfig.h>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
 
 #if (CISST_OS == CISST_WINDOWS)
 #include <Windows.h>
@@ -31,14 +40,113 @@ http://www.cisst.org/cisst/license.txt.
 #include <3DconnexionClient/ConnexionClientAPI.h>
 #elif (SAW_HAS_SPACENAV)
 //see http://spacenav.sourceforge.net/faq.html
-#include <spnav.h>
+#include <saw3Dconnexion/osa3DconnexionSpacenav.h>
+#include <saw3Dconnexion/osa3DconnexionLog.h>
+#include <saw3Dconnexion/osa3Dconnexion.h>
+#include <saw3Dconnexion/osa3DconnexionGenerator.h>
+#include <saw3Dconnexion/osa3DconnexionHistogram.h>
+#include <saw3Dconnexion/osa3DconnexionShm.h>
+#include <saw3Dconnexion/osa3DconnexionUdp.h>
+#if (SAW_HAS_UDEV)
+#include <saw3Dconnexion/osa3DconnexionHotplug.h>
+#include <set>
+#endif
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
 #endif
 
 CMN_IMPLEMENT_SERVICES_DERIVED_ONEARG(mts3Dconnexion, mtsTaskPeriodic, mtsTaskPeriodicConstructorArg);
 
+struct mts3DconnexionSample
+{
+    double Timestamp;   // time the sample was read
+    long long SourceTime;  // device time, read time for spacenavd (us, monotonic)
+    long long ReadTime;    // time the sample was read (us, monotonic)
+    bool Motion;        // motion or button sample
+    double Axis[6];
+    int Button;
+    bool Pressed;
+};
+
+
+// time used to integrate the axes, the device time when available (s)
+static inline double mts3DconnexionSampleTime(const mts3DconnexionSample & sample)
+{
+    return sample.SourceTime * cmn_us;
+}
+
+
+// clock of the sample times, used to condition the axes (s)
+static inline double mts3DconnexionNow(void)
+{
+#if (SAW_HAS_SPACENAV)
+    return osa3DconnexionLog::Now() * cmn_us;
+#else
+    return osaGetTime();
+#endif
+}
+
+
+struct mts3DconnexionRecord
+{
+    double Timestamp;
+    double Axis[6];
+    unsigned int Buttons;
+};
+
+
+struct mts3DconnexionEdge
+{
+    double Timestamp;
+    int Button;
+    bool Pressed;
+};
+
+
+// input latched by the message handler
+struct mts3DconnexionInput
+{
+    double Axis[6];
+    unsigned int Buttons;
+};
+
+
+// output copied by the lock free readers
+struct mts3DconnexionOutput
+{
+    double Timestamp;
+    double Axis[6];
+    double Translation[3];
+    double Rotation[9];  // row major
+};
+
+
 class mts3DconnexionData
 {
   public:
+    // last timestamped button edges pushed by the component, read by
+    // GetButtonEdgesSince in the consumer threads
+    enum {EDGES = 256};
+    osaMutex EdgesMutex;
+    mts3DconnexionEdge Edges[EDGES];
+    unsigned long long EdgesNext;  // index of the next edge
+    void PushEdge(int button, bool pressed, double time);
+
+    // history of the axes and buttons advanced, read by
+    // GetAxisHistorySince in the consumer threads
+    osaMutex HistoryMutex;
+    std::vector<mts3DconnexionRecord> History;  // sized in Configure
+    unsigned long long HistoryNext;  // index of the next record
+
+    // input written by the message handler thread and processed by Run,
+    // output written by Run and read by GetAxisData and
+    // GetPositionCartesian in the consumer threads
+    mts3DconnexionSnapshot<mts3DconnexionInput> Input;
+    unsigned int InputVersion;  // last input processed
+    mts3DconnexionSnapshot<mts3DconnexionOutput> Output;
+
 #if (CISST_OS == CISST_WINDOWS)
     ISimpleDevicePtr _3DxDevice;
     ISensor * m_p3DSensor;
@@ -55,18 +163,435 @@ class mts3DconnexionData
 #endif
 
 #if (SAW_HAS_SPACENAV)
-    spnav_event SpnavEvent;
+    // connection to spacenavd owned by this instance
+    std::string SocketName;
+    osa3DconnexionSpacenav Spacenav;
+    osa3DconnexionSpacenav::Event SpacenavEvents[osa3DconnexionSpacenav::BUFFERSIZE];
+
+    // raw spacenavd events recorded or replayed instead of spacenavd
+    osa3DconnexionLog Recorder;
+    osa3DconnexionLog Replay;
+    osa3DconnexionLog::Record Records[osa3DconnexionSpacenav::BUFFERSIZE];
+
+    // device read directly (joystick, evdev, FIFO, virtual or replayed
+    // device) instead of spacenavd
+    bool UseDevice;
+    osa3Dconnexion Device;
+    osa3Dconnexion::Event DeviceEvents[osa3DconnexionSpacenav::BUFFERSIZE];
+    osa3DconnexionGenerator Generator;
+    osa3DconnexionGenerator::Profile Profile;
+    bool UseGenerator;
+
+    // samples converted from the events read (by the reader thread if
+    // any) and samples consumed from the ring by Run
+    mts3DconnexionSample Samples[osa3DconnexionSpacenav::BUFFERSIZE];
+    mts3DconnexionSample Batch[osa3DconnexionSpacenav::BUFFERSIZE];
+
+    // reader thread and ring buffer, the reader is the only producer and
+    // Run is the only consumer
+    osaThread ReaderThread;
+    int WakeupFD;
+    int RingFD;   // signaled by the reader when event driven
+    volatile bool ReaderRunning;
+    mts3Dconnexion::BackpressureType Backpressure;
+    mtsQueue<mts3DconnexionSample> Ring;
+    // samples kept aside in order when the ring is full with KEEP_LATEST,
+    // all the button samples and only the latest motion sample between
+    // them, written and flushed by the reader only
+    enum {PENDING = 256};
+    mts3DconnexionSample Pending[PENDING];
+    size_t PendingFirst;
+    size_t PendingCount;
+    volatile unsigned int Overflows;
+    bool SignalRing;
+
+    // spacenavd can be restarted, the connection is reopened at most once
+    // per second (by the reader thread if any)
+    volatile bool DaemonConnected;
+    double LastReconnect;
+
+    // latency histograms (us) from the device to the read, from the read
+    // to Advance and from Advance to the first consumer read, Run is the
+    // only writer except for the consumer histogram
+    bool SourceTimestamps;  // the device timestamps are on the monotonic clock
+    osa3DconnexionHistogram ReadLatency;
+    osa3DconnexionHistogram AdvanceLatency;
+    osa3DconnexionHistogram ConsumerLatency;
+    volatile long long LastAdvance;         // time of the last Advance
+    volatile unsigned long long Advances;   // number of samples advanced
+    volatile unsigned long long Consumed;   // last Advance read by a consumer
+    volatile unsigned long long MotionSamples;
+    volatile unsigned long long ButtonSamples;
+    volatile long long StatisticsStart;
+
+    // latest sample published for other processes
+    osa3DconnexionShm Shm;
+
+    // samples streamed to another host, sample packets are only sent when
+    // the state changes, repeated a few times, then idle packets
+    osa3DconnexionUdp Stream;
+    osa3DconnexionUdp::Packet StreamSample;  // last sample packet sent
+    bool StreamStarted;
+    unsigned int StreamRepeats;  // sample packets sent since the last change
+    double StreamLastSample;     // time of the last sample packet
+    double StreamLastSent;       // time of the last packet
+
+#if (SAW_HAS_UDEV)
+    // device nodes of the 3Dconnexion devices currently plugged
+    osa3DconnexionHotplug Hotplug;
+    bool HotplugActive;
+    std::set<std::string> DeviceNodes;
+#endif
+
+    void * Reader(mts3Dconnexion * instance);
+    void Push(const mts3DconnexionSample & sample);
+    void Flush(void);
+    void Reconnect(void);
+    void NoDevice(void);
+    bool Connected(void);
+    size_t ReadSamples(double timeout);
+    void Record(size_t count);
+    int FileDescriptor(void) const;
+    void Advanced(const mts3DconnexionSample & sample);
+    void ConsumerRead(void);
+    void ResetStatistics(void);
 #endif
 };
 
 
-void mts3DconnexionInternalMessageHandler(mts3Dconnexion * instance, const vctDynamicVector<double> & axis, const vctDynamicVector<bool> & buttons)
+void mts3DconnexionData::PushEdge(int button, bool pressed, double time)
+{
+    EdgesMutex.Lock();
+    mts3DconnexionEdge & edge = Edges[EdgesNext % EDGES];
+    edge.Timestamp = time;
+    edge.Button = button;
+    edge.Pressed = pressed;
+    ++EdgesNext;
+    EdgesMutex.Unlock();
+}
+
+
+#if (SAW_HAS_SPACENAV)
+static void mts3DconnexionFromSpnav(const osa3DconnexionSpacenav::Event & event, mts3DconnexionSample & sample)
 {
-    instance->DataTable->Start();
-    instance->Axis.Assign(axis);
-    instance->Buttons.Assign(buttons);
-    instance->UpdateDataTable();
-    instance->DataTable->Advance();
+    sample.Timestamp = osaGetTime();
+    // spacenavd doesn't forward the device time
+    sample.ReadTime = osa3DconnexionLog::Now();
+    sample.SourceTime = sample.ReadTime;
+    if (event.type == osa3DconnexionSpacenav::Event::MOTION) {
+        // device axes, mapped to the component axes by the transform
+        // the limits are +/- 350 for all inputs
+        sample.Motion = true;
+        for (size_t i = 0; i < 6; ++i) {
+            sample.Axis[i] = event.data[i];
+        }
+    }
+    else {	/* SPNAV_EVENT_BUTTON */
+        // axes are transformed in batches with the motion samples
+        for (size_t i = 0; i < 6; ++i) {
+            sample.Axis[i] = 0.0;
+        }
+        sample.Motion = false;
+        sample.Button = event.button;
+        sample.Pressed = (event.type == osa3DconnexionSpacenav::Event::BUTTON_PRESSED);
+    }
+}
+
+
+void mts3DconnexionData::Push(const mts3DconnexionSample & sample)
+{
+    // try to flush the samples kept aside first to preserve the order
+    Flush();
+    if ((PendingCount == 0) && Ring.Put(sample)) {
+        return;
+    }
+    // ring is full
+    Overflows = Overflows + 1;
+    if (Backpressure != mts3Dconnexion::KEEP_LATEST) {
+        return;
+    }
+    // a motion sample replaces the motion sample kept aside after the
+    // last button sample, button samples are never replaced
+    if (PendingCount != 0) {
+        mts3DconnexionSample & last = Pending[(PendingFirst + PendingCount - 1) % PENDING];
+        if (sample.Motion && last.Motion) {
+            last = sample;
+            return;
+        }
+    }
+    if (PendingCount == PENDING) {
+        // only if Run is stalled with PENDING / 2 button samples aside
+        CMN_LOG_RUN_ERROR << "mts3DconnexionData::Push: sample lost, component stalled" << std::endl;
+        return;
+    }
+    Pending[(PendingFirst + PendingCount) % PENDING] = sample;
+    ++PendingCount;
+}
+
+
+void mts3DconnexionData::Flush(void)
+{
+    while ((PendingCount != 0) && Ring.Put(Pending[PendingFirst])) {
+        PendingFirst = (PendingFirst + 1) % PENDING;
+        --PendingCount;
+    }
+}
+
+
+static bool mts3DconnexionFromDevice(const osa3Dconnexion::Event & event, mts3DconnexionSample & sample)
+{
+    sample.Timestamp = osaGetTime();
+    sample.ReadTime = osa3DconnexionLog::Now();
+    sample.SourceTime = event.utimestamp;
+    if (event.type == osa3Dconnexion::Event::MOTION) {
+        // same axes as spacenavd
+        sample.Motion = true;
+        for (size_t i = 0; i < 6; ++i) {
+            sample.Axis[i] = static_cast<double>(event.values[i]);
+        }
+        return true;
+    }
+    if ((event.type == osa3Dconnexion::Event::BUTTON_PRESSED)
+        || (event.type == osa3Dconnexion::Event::BUTTON_RELEASED)) {
+        for (size_t i = 0; i < 6; ++i) {
+            sample.Axis[i] = 0.0;
+        }
+        sample.Motion = false;
+        sample.Button = (event.button == osa3Dconnexion::Event::BUTTON1) ? 0 : 1;
+        sample.Pressed = (event.type == osa3Dconnexion::Event::BUTTON_PRESSED);
+        return true;
+    }
+    return false;
+}
+
+
+size_t mts3DconnexionData::ReadSamples(double timeout)
+{
+    size_t count = 0;
+    if (UseDevice) {
+        // the device waits for the timeout and reopens itself if unplugged
+        size_t events = Device.ReadEvents(DeviceEvents, osa3DconnexionSpacenav::BUFFERSIZE, timeout);
+        for (size_t i = 0; i < events; ++i) {
+            if (mts3DconnexionFromDevice(DeviceEvents[i], Samples[count])) {
+                if (!SourceTimestamps) {
+                    Samples[count].SourceTime = Samples[count].ReadTime;
+                }
+                ++count;
+            }
+        }
+        return count;
+    }
+    if (!Replay.IsReplaying()) {
+        count = Spacenav.ReadEvents(SpacenavEvents, osa3DconnexionSpacenav::BUFFERSIZE);
+        if ((count != 0) && Recorder.IsRecording()) {
+            Record(count);
+        }
+    } else {
+        // replay the records that are due
+        size_t records = Replay.Read(Records, osa3DconnexionSpacenav::BUFFERSIZE);
+        for (size_t i = 0; i < records; ++i) {
+            if (Records[i].source == osa3DconnexionLog::Record::SPACENAV) {
+                osa3DconnexionSpacenav::Event & event = SpacenavEvents[count++];
+                event.type = static_cast<osa3DconnexionSpacenav::Event::Type>(Records[i].type);
+                for (size_t j = 0; j < 6; ++j) {
+                    event.data[j] = Records[i].value[j];
+                }
+                event.period = Records[i].aux;
+                event.button = Records[i].code;
+            }
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        mts3DconnexionFromSpnav(SpacenavEvents[i], Samples[i]);
+    }
+    return count;
+}
+
+
+int mts3DconnexionData::FileDescriptor(void) const
+{
+    return UseDevice ? Device.GetFileDescriptor() : Spacenav.GetFileDescriptor();
+}
+
+
+void mts3DconnexionData::Advanced(const mts3DconnexionSample & sample)
+{
+    const long long now = osa3DconnexionLog::Now();
+    ReadLatency.Add(sample.ReadTime - sample.SourceTime);
+    AdvanceLatency.Add(now - sample.ReadTime);
+    if (sample.Motion) {
+        MotionSamples = MotionSamples + 1;
+    } else {
+        ButtonSamples = ButtonSamples + 1;
+    }
+    // publish the time before the counter read by the consumers
+    LastAdvance = now;
+    __sync_synchronize();
+    Advances = Advances + 1;
+}
+
+
+void mts3DconnexionData::ConsumerRead(void)
+{
+    // only the first read after each Advance is counted
+    const unsigned long long advances = Advances;
+    const unsigned long long consumed = Consumed;
+    __sync_synchronize();
+    const long long advance = LastAdvance;
+    if ((advances != consumed)
+        && __sync_bool_compare_and_swap(&Consumed, consumed, advances)) {
+        ConsumerLatency.Add(osa3DconnexionLog::Now() - advance);
+    }
+}
+
+
+void mts3DconnexionData::ResetStatistics(void)
+{
+    ReadLatency.Reset();
+    AdvanceLatency.Reset();
+    ConsumerLatency.Reset();
+    MotionSamples = 0;
+    ButtonSamples = 0;
+    StatisticsStart = osa3DconnexionLog::Now();
+}
+
+
+void mts3DconnexionData::Record(size_t count)
+{
+    long long now = osa3DconnexionLog::Now();
+    for (size_t i = 0; i < count; ++i) {
+        osa3DconnexionLog::Record & record = Records[i];
+        record.utimestamp = now;
+        record.source = osa3DconnexionLog::Record::SPACENAV;
+        record.type = static_cast<unsigned short>(SpacenavEvents[i].type);
+        record.code = static_cast<unsigned short>(SpacenavEvents[i].button);
+        record.aux = static_cast<unsigned short>(SpacenavEvents[i].period);
+        for (size_t j = 0; j < 6; ++j) {
+            record.value[j] = SpacenavEvents[i].data[j];
+        }
+    }
+    Recorder.Write(Records, count);
+}
+
+
+void mts3DconnexionData::Reconnect(void)
+{
+    double now = osaGetTime();
+    if (now - LastReconnect < 1.0 * cmn_s) {
+        return;
+    }
+    LastReconnect = now;
+    // the socket is removed when spacenavd stops
+    if (SocketName.empty() || (access(SocketName.c_str(), F_OK) != 0)) {
+        return;
+    }
+    if (Spacenav.Open(SocketName) == osa3DconnexionSpacenav::ESUCCESS) {
+        DaemonConnected = true;
+        CMN_LOG_RUN_WARNING << "mts3DconnexionData::Reconnect: reconnected to " << SocketName << std::endl;
+    }
+}
+
+
+bool mts3DconnexionData::Connected(void)
+{
+#if (SAW_HAS_UDEV)
+    if (HotplugActive) {
+        osa3DconnexionHotplug::Event event;
+        while (Hotplug.ReadEvent(event)) {
+            if (event.type == osa3DconnexionHotplug::Event::ADDED) {
+                DeviceNodes.insert(event.devnode);
+            } else {
+                DeviceNodes.erase(event.devnode);
+            }
+        }
+        return DaemonConnected && !DeviceNodes.empty();
+    }
+#endif
+    return DaemonConnected;
+}
+
+
+void mts3DconnexionData::NoDevice(void)
+{
+    // nothing to read or reconnect to, the readers only wait for Cleanup
+    UseDevice = false;
+    UseGenerator = false;
+    DaemonConnected = false;
+    SocketName.clear();
+}
+
+
+void * mts3DconnexionData::Reader(mts3Dconnexion * CMN_UNUSED(instance))
+{
+    struct pollfd fds[2];
+    fds[0].events = POLLIN;
+    fds[1].fd = WakeupFD;
+    fds[1].events = POLLIN;
+    size_t count;
+
+    while (ReaderRunning) {
+        if (UseDevice) {
+            // the device waits, Cleanup interrupts the wait
+            count = ReadSamples((PendingCount != 0) ? 1.0 * cmn_ms : -1.0);
+            for (size_t i = 0; i < count; ++i) {
+                Push(Samples[i]);
+            }
+        } else {
+            // wake up periodically to flush the samples kept aside or to
+            // reconnect, a negative file descriptor is ignored by poll
+            fds[0].fd = Spacenav.GetFileDescriptor();
+            fds[0].revents = 0;
+            fds[1].revents = 0;
+            int ms = -1;
+            if (PendingCount != 0) {
+                ms = 1;
+            } else if ((fds[0].fd == -1) && !SocketName.empty()) {
+                ms = 1000;
+            }
+            if (poll(fds, 2, ms) == -1) {
+                continue;
+            }
+            if (fds[1].revents & POLLIN) {
+                break;
+            }
+            if (fds[0].fd == -1) {
+                Reconnect();
+                continue;
+            }
+        }
+        while ((count = ReadSamples(0.0)) != 0) {
+            for (size_t i = 0; i < count; ++i) {
+                Push(Samples[i]);
+            }
+        }
+        Flush();
+        DaemonConnected = UseDevice ? Device.IsConnected() : Spacenav.IsOpened();
+        // wake up the component
+        if (SignalRing) {
+            uint64_t one = 1;
+            if (write(RingFD, &one, sizeof(one)) == -1) {
+                CMN_LOG_RUN_ERROR << "mts3DconnexionData::Reader: failed to signal ring" << std::endl;
+            }
+        }
+    }
+    return 0;
+}
+#endif
+
+
+void mts3DconnexionInternalMessageHandler(mts3Dconnexion * instance, const vct6 & axis, const vctFixedSizeVector<bool, 2> & buttons)
+{
+    mts3DconnexionInput input;
+    input.Buttons = 0;
+    for (unsigned int i = 0; i < mts3Dconnexion::StateType::NumAxes; ++i) {
+        input.Axis[i] = axis[i];
+    }
+    for (unsigned int i = 0; i < mts3Dconnexion::StateType::NumButtons; ++i) {
+        if (buttons[i]) {
+            input.Buttons |= (1u << i);
+        }
+    }
+    instance->Data->Input.Write(input);
 }
 
 
@@ -85,11 +610,11 @@ void mts3DconnexionMessageHandler(io_connect_t, natural_t messageType, void * me
         state = reinterpret_cast<ConnexionDeviceState *>(messageArgument);
         instance = saw3DconnexionIdToInstanceMap.find(state->client);
         if (instance != saw3DconnexionIdToInstanceMap.end()) {
-            vctDoubleVec axis(6);
+            vct6 axis;
             for (unsigned int i = 0; i < axis.size(); ++i) {
                 axis[i] = state->axis[i];
             }
-            vctBoolVec buttons(2);
+            vctFixedSizeVector<bool, 2> buttons;
             buttons[0] = (state->buttons == 1) | (state->buttons == 3);
             buttons[1] = (state->buttons == 2) | (state->buttons == 3);
             mts3DconnexionInternalMessageHandler(instance->second, axis, buttons);
@@ -120,25 +645,224 @@ void mts3Dconnexion::Cleanup(void)
 #endif
 
 #if (SAW_HAS_SPACENAV)
-    spnav_close();
+    if (Data->ReaderRunning) {
+        Data->ReaderRunning = false;
+        uint64_t one = 1;
+        if (write(Data->WakeupFD, &one, sizeof(one)) == -1) {
+            CMN_LOG_CLASS_RUN_ERROR << "Cleanup: failed to wake up reader thread" << std::endl;
+        }
+        Data->Device.Interrupt();
+        Data->ReaderThread.Join();
+    }
+    if (Data->WakeupFD != -1) {
+        close(Data->WakeupFD);
+        Data->WakeupFD = -1;
+    }
+    if (Data->RingFD != -1) {
+        close(Data->RingFD);
+        Data->RingFD = -1;
+    }
+    Data->Spacenav.Close();
+    Data->Generator.Stop();
+    Data->Device.Close();
+    Data->Recorder.Close();
+    Data->Replay.Close();
+    Data->Shm.Close();
+    Data->Stream.Close();
+#if (SAW_HAS_UDEV)
+    Data->Hotplug.Close();
+#endif
+#endif
+
+}
+
+
+void mts3Dconnexion::Init(void)
+{
+    NextWakeup = 0.0;
+    UseReaderThread = false;
+    RingSize = 256;
+    Backpressure = KEEP_ALL;
+    RingOccupancy = 0;
+    RingOverflows = 0;
+    ReplayRate = 1.0;
+    MotionEventRate = 200.0;
+    LastMotionEvent = 0.0;
+    MotionPending = false;
+}
+
+
+bool mts3Dconnexion::CheckEventDriven(bool eventDriven)
+{
+#if (SAW_HAS_SPACENAV)
+    return eventDriven;
+#else
+    return false;
+#endif
+}
+
+
+void mts3Dconnexion::WaitForInput(void)
+{
+#if (SAW_HAS_SPACENAV)
+    // the periodic task sleeps between runs
+    if (EventDriven) {
+        double now = osaGetTime();
+        // skip missed periods instead of trying to catch up
+        if ((NextWakeup < now - Period) || (NextWakeup > now + Period)) {
+            NextWakeup = now;
+        }
+        // also wake up when a device is plugged or unplugged, negative
+        // file descriptors are ignored by poll
+        int fd = Data->ReaderRunning ? Data->RingFD : Data->FileDescriptor();
+        struct pollfd pfd[2];
+        pfd[0].fd = fd;
+        pfd[1].fd = -1;
+#if (SAW_HAS_UDEV)
+        if (Data->HotplugActive) {
+            pfd[1].fd = Data->Hotplug.GetFileDescriptor();
+        }
+#endif
+        pfd[0].events = pfd[1].events = POLLIN;
+        pfd[0].revents = pfd[1].revents = 0;
+        int ms = static_cast<int>((NextWakeup - now) / cmn_ms);
+        if (ms < 0) {
+            ms = 0;
+        }
+        int result = poll(pfd, 2, ms);
+        if ((result > 0) && ((pfd[0].revents | pfd[1].revents) & POLLIN)) {
+            if ((fd == Data->RingFD) && (pfd[0].revents & POLLIN)) {
+                uint64_t count;
+                if (read(Data->RingFD, &count, sizeof(count)) == -1) {
+                    CMN_LOG_CLASS_RUN_ERROR << "WaitForInput: failed to clear ring signal" << std::endl;
+                }
+            }
+            // data is available, keep the period for the command watchdog
+            return;
+        }
+        NextWakeup += Period;
+    }
+#endif
+}
+
+
+void mts3Dconnexion::SetReaderThread(bool enable, size_t ringSize,
+                                     BackpressureType backpressure)
+{
+#if (SAW_HAS_SPACENAV)
+    UseReaderThread = enable;
+    RingSize = ringSize;
+    Backpressure = backpressure;
+#else
+    if (enable) {
+        CMN_LOG_CLASS_INIT_WARNING << "SetReaderThread: reader thread is only supported with spacenavd" << std::endl;
+    }
+#endif
+}
+
+
+void mts3Dconnexion::SetRecording(const std::string & fileName)
+{
+#if (SAW_HAS_SPACENAV)
+    RecordingFile = fileName;
+#else
+    if (!fileName.empty()) {
+        CMN_LOG_CLASS_INIT_WARNING << "SetRecording: recording is only supported with spacenavd" << std::endl;
+    }
 #endif
+}
+
 
+void mts3Dconnexion::SetSharedMemory(const std::string & name)
+{
+#if (SAW_HAS_SPACENAV)
+    SharedMemoryName = name;
+#else
+    if (!name.empty()) {
+        CMN_LOG_CLASS_INIT_WARNING << "SetSharedMemory: shared memory is only supported on Linux" << std::endl;
+    }
+#endif
 }
 
 
-void mts3Dconnexion::Configure(const std::string & configurationName)
+void mts3Dconnexion::SetStreaming(const std::string & destination)
 {
+#if (SAW_HAS_SPACENAV)
+    StreamDestination = destination;
+#else
+    if (!destination.empty()) {
+        CMN_LOG_CLASS_INIT_WARNING << "SetStreaming: streaming is only supported on Linux" << std::endl;
+    }
+#endif
+}
+
+
+void mts3Dconnexion::SetReplayRate(double rate)
+{
+    ReplayRate = rate;
+}
+
+
+void mts3Dconnexion::Configure(const std::string & configuration)
+{
+    // conditioning options follow the device, separated by commas
+    const size_t comma = configuration.find(',');
+    const std::string configurationName = configuration.substr(0, comma);
     Data = new mts3DconnexionData;
+    Data->EdgesNext = 0;
+    Data->HistoryNext = 0;
+    Data->InputVersion = Data->Input.GetVersion();
     ConfigurationName = configurationName;
-    Axis.SetSize(6);
+    Axis.SetSize(StateType::NumAxes);
     Axis.SetAll(0.0);
-    Buttons.SetSize(2);
+    Buttons.SetSize(StateType::NumButtons);
     Buttons.SetAll(false);
-    Mask.SetSize(6);
+    EventAxis.SetSize(StateType::NumAxes);
+    EventAxis.SetAll(0.0);
+    EventButtons = 0;
+    Mask.SetSize(StateType::NumAxes);
     Mask.SetAll(true);
     Gain = 1.0;
 
+    // device axes to component axes, identity except for spacenavd and
+    // the kernel which use a left handed coordinate system:
+    // X to the right (as looking at the sign)
+    // Y is down
+    // Z is back (towards cable)
+    DeviceTransform.SetAll(0.0);
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        DeviceTransform.Element(i, i) = 1.0;
+    }
+#if (SAW_HAS_SPACENAV)
+    DeviceTransform.Element(1, 1) = -1.0;
+    DeviceTransform.Element(4, 4) = -1.0;
+#endif
+    // component axes to robot axes, can be set with SetAxisTransform
+    AxisTransform.SetSize(StateType::NumAxes, StateType::NumAxes);
+    AxisTransform.SetAll(0.0);
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        AxisTransform.Element(i, i) = 1.0;
+    }
+    UpdateTransform();
+
+    // signal conditioning of the device counts and integration, the range
+    // follows the backend and can be overridden with "range=<counts>"
+#if (CISST_OS == CISST_WINDOWS)
+    Conditioning.SetRange(1600);
+#else
+    if (configurationName.compare(0, 3, "js:") == 0) {
+        Conditioning.SetRange(32767);  // joystick axes are scaled to 16 bits
+    } else {
+        Conditioning.SetRange(350);    // spacenavd and event devices
+    }
+#endif
+    if (comma != std::string::npos) {
+        ParseOptions(configuration.substr(comma + 1));
+    }
+    CopySettings();
+
     DataTable = new mtsStateTable(StateTable.GetHistoryLength(), "3Dconnexion");
+    Data->History.resize(StateTable.GetHistoryLength());
     AddStateTable(DataTable);
 #if (CISST_OS == CISST_DARWIN || SAW_HAS_SPACENAV)
     DataTable->SetAutomaticAdvance(false);  // state table is populated in MessageHandler
@@ -147,22 +871,69 @@ void mts3Dconnexion::Configure(const std::string & configurationName)
 #endif
     DataTable->AddData(Axis, "AxisData");
     DataTable->AddData(Buttons, "ButtonData");
+    DataTable->AddData(ButtonMask, "ButtonMask");
     DataTable->AddData(Mask, "AxisMask");
     DataTable->AddData(Gain, "Gain");
+    DataTable->AddData(AxisTransform, "AxisTransform");
+    DataTable->AddData(CountRange, "CountRange");
+    DataTable->AddData(Deadzone, "Deadzone");
+    DataTable->AddData(ResponseExponent, "ResponseExponent");
+    DataTable->AddData(Filter, "Filter");
+    DataTable->AddData(VelocityScale, "VelocityScale");
+    DataTable->AddData(VelocityLimits, "VelocityLimits");
+    DataTable->AddData(Bias, "Bias");
+    DataTable->AddData(BiasWindow, "BiasWindow");
+    DataTable->AddData(DriftCompensation, "DriftCompensation");
+    DataTable->AddData(MotionEventRate, "MotionEventRate");
     DataTable->AddData(Position, "Position");
     DataTable->AddData(IsConnected, "IsConnected");
+    StateTable.AddData(RingOccupancy, "RingOccupancy");
+    StateTable.AddData(RingOverflows, "RingOverflows");
 
     mtsInterfaceProvided * providesSpaceNavigator = AddInterfaceProvided("ProvidesSpaceNavigator");
     if (providesSpaceNavigator) {
-        providesSpaceNavigator->AddCommandReadState(*DataTable, Axis, "GetAxisData");
+        // reads of the axes and position are timed for the latency statistics
+        providesSpaceNavigator->AddCommandRead(&mts3Dconnexion::GetAxisData, this, "GetAxisData");
         providesSpaceNavigator->AddCommandReadState(*DataTable, Buttons, "GetButtonData");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, ButtonMask, "GetButtonMask");
+        providesSpaceNavigator->AddCommandQualifiedRead(&mts3Dconnexion::GetButtonEdgesSince, this, "GetButtonEdgesSince");
+        providesSpaceNavigator->AddCommandQualifiedRead(&mts3Dconnexion::GetAxisHistorySince, this, "GetAxisHistorySince");
         providesSpaceNavigator->AddCommandReadState(*DataTable, Mask, "GetAxisMask");
         providesSpaceNavigator->AddCommandWriteState(*DataTable, Mask, "SetAxisMask");
         providesSpaceNavigator->AddCommandReadState(*DataTable, Gain, "GetGain");
         providesSpaceNavigator->AddCommandWriteState(*DataTable, Gain, "SetGain");
-        providesSpaceNavigator->AddCommandReadState(*DataTable, Position, "GetPositionCartesian");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, AxisTransform, "GetAxisTransform");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetAxisTransform, this, "SetAxisTransform");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, CountRange, "GetCountRange");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetCountRange, this, "SetCountRange");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, Deadzone, "GetDeadzone");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetDeadzone, this, "SetDeadzone");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, ResponseExponent, "GetResponseExponent");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetResponseExponent, this, "SetResponseExponent");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, Filter, "GetFilter");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetFilter, this, "SetFilter");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, VelocityScale, "GetVelocityScale");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetVelocityScale, this, "SetVelocityScale");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, VelocityLimits, "GetVelocityLimits");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetVelocityLimits, this, "SetVelocityLimits");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, Bias, "GetBias");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, BiasWindow, "GetBiasWindow");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetBiasWindow, this, "SetBiasWindow");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, DriftCompensation, "GetDriftCompensation");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetDriftCompensation, this, "SetDriftCompensation");
+        providesSpaceNavigator->AddCommandReadState(*DataTable, MotionEventRate, "GetMotionEventRate");
+        providesSpaceNavigator->AddCommandWrite(&mts3Dconnexion::SetMotionEventRate, this, "SetMotionEventRate");
+        // events, the payloads are timestamped
+        providesSpaceNavigator->AddEventWrite(MotionEvent, "MotionEvent", EventAxis);
+        providesSpaceNavigator->AddEventWrite(ButtonPressed, "ButtonPressed", EventButton);
+        providesSpaceNavigator->AddEventWrite(ButtonReleased, "ButtonReleased", EventButton);
+        providesSpaceNavigator->AddCommandRead(&mts3Dconnexion::GetPositionCartesian, this, "GetPositionCartesian");
         providesSpaceNavigator->AddCommandVoid(&mts3Dconnexion::ReBias, this, "ReBias");
         providesSpaceNavigator->AddCommandReadState(*DataTable, IsConnected, "GetIsConnected");
+        providesSpaceNavigator->AddCommandReadState(StateTable, RingOccupancy, "GetRingOccupancy");
+        providesSpaceNavigator->AddCommandReadState(StateTable, RingOverflows, "GetRingOverflows");
+        providesSpaceNavigator->AddCommandRead(&mts3Dconnexion::GetLatencyStatistics, this, "GetLatencyStatistics");
+        providesSpaceNavigator->AddCommandVoid(&mts3Dconnexion::ResetLatencyStatistics, this, "ResetLatencyStatistics");
     }
 
 #if (CISST_OS == CISST_DARWIN)
@@ -191,13 +962,113 @@ void mts3Dconnexion::Configure(const std::string & configurationName)
 #endif
 
 #if (SAW_HAS_SPACENAV)
-    if(spnav_open()==-1) {
-        CMN_LOG_CLASS_INIT_ERROR << ("failed to connect to the space navigator daemon\n ");
-        IsConnected = false;
+    Data->WakeupFD = -1;
+    Data->RingFD = -1;
+    Data->SignalRing = false;
+    Data->ReaderRunning = false;
+    Data->PendingFirst = 0;
+    Data->PendingCount = 0;
+    Data->Overflows = 0;
+    Data->LastReconnect = osaGetTime();
+    // on Linux, the configuration name can be used to select another
+    // spacenavd socket, i.e. "spacenavd:/tmp/spnav.sock"
+    Data->SocketName = "/var/run/spnav.sock";
+    if (configurationName.compare(0, 10, "spacenavd:") == 0) {
+        Data->SocketName = configurationName.substr(10);
+    }
+#if (SAW_HAS_UDEV)
+    Data->HotplugActive = false;
+#endif
+    Data->UseDevice = false;
+    Data->UseGenerator = false;
+    Data->SourceTimestamps = false;
+    Data->LastAdvance = 0;
+    Data->Advances = 0;
+    Data->Consumed = 0;
+    Data->StreamStarted = false;
+    Data->StreamRepeats = 0;
+    Data->StreamLastSample = 0.0;
+    Data->StreamLastSent = 0.0;
+    Data->ResetStatistics();
+    // or "replay:<log>" to replay a log created with SetRecording
+    if (configurationName.compare(0, 7, "replay:") == 0) {
+        const std::string fileName = configurationName.substr(7);
+        Data->DaemonConnected = (Data->Replay.Load(fileName) == osa3DconnexionLog::ESUCCESS);
+        // device events are replayed by the device
+        if (Data->DaemonConnected && (Data->Replay.GetSize() != 0)
+            && (Data->Replay.GetRecords()[0].source != osa3DconnexionLog::Record::SPACENAV)) {
+            Data->Replay.Close();
+            Data->UseDevice = true;
+            Data->Device.SetCoalescing(true);
+            Data->DaemonConnected = (Data->Device.Open(fileName, osa3Dconnexion::REPLAY) == osa3Dconnexion::ESUCCESS);
+        }
+        if (!Data->DaemonConnected) {
+            CMN_LOG_CLASS_INIT_ERROR << "Configure: failed to load log " << fileName << std::endl;
+            Data->NoDevice();
+        }
+        IsConnected = Data->Connected();
         return;
     }
+    // "js:<device>" or "evdev:<device>" to read a joystick or event device
+    // (or a FIFO of raw events) directly and "virtual:<profile>" to read
+    // generated events (see osa3DconnexionGenerator::Parse)
+    if ((configurationName.compare(0, 3, "js:") == 0)
+        || (configurationName.compare(0, 6, "evdev:") == 0)) {
+        const bool evdev = (configurationName[0] == 'e');
+        const std::string fileName = configurationName.substr(evdev ? 6 : 3);
+        Data->UseDevice = true;
+        Data->SourceTimestamps = true;
+        Data->Device.SetCoalescing(true);
+        const bool hotplug = (Data->Device.SetHotplug(true) == osa3Dconnexion::ESUCCESS);
+        if (Data->Device.Open(fileName, evdev ? osa3Dconnexion::EVDEV : osa3Dconnexion::JOYSTICK) != osa3Dconnexion::ESUCCESS) {
+            CMN_LOG_CLASS_INIT_ERROR << "Configure: failed to open device " << fileName << std::endl;
+            // without hotplug, the device will not come back
+            if (!hotplug) {
+                Data->NoDevice();
+            }
+        }
+        Data->DaemonConnected = Data->Device.IsConnected();
+        IsConnected = Data->Connected();
+        return;
+    }
+    if (configurationName.compare(0, 8, "virtual:") == 0) {
+        Data->SourceTimestamps = true;
+        Data->Device.SetCoalescing(true);
+        Data->UseGenerator = (osa3DconnexionGenerator::Parse(configurationName.substr(8), Data->Profile) == osa3DconnexionGenerator::ESUCCESS);
+        Data->UseDevice = Data->UseGenerator;
+        if (!Data->UseGenerator) {
+            CMN_LOG_CLASS_INIT_ERROR << "Configure: invalid virtual device " << configurationName << std::endl;
+            Data->NoDevice();
+        }
+        // the generator is started by Startup
+        Data->DaemonConnected = Data->UseGenerator;
+        IsConnected = Data->Connected();
+        return;
+    }
+    // keep going, the connection is retried in Run
+    Data->DaemonConnected = (Data->Spacenav.Open(Data->SocketName) == osa3DconnexionSpacenav::ESUCCESS);
+    if (!Data->DaemonConnected) {
+        CMN_LOG_CLASS_INIT_ERROR << "Configure: failed to connect to the space navigator daemon on "
+                                 << Data->SocketName << std::endl;
+    }
+#if (SAW_HAS_UDEV)
+    // spacenavd keeps the socket opened when the device is unplugged, use
+    // udev to know if a device is present
+    std::vector<osa3DconnexionHotplug::Event> devices;
+    if ((Data->Hotplug.Open() == osa3DconnexionHotplug::ESUCCESS)
+        && (Data->Hotplug.Scan(devices) == osa3DconnexionHotplug::ESUCCESS)) {
+        for (size_t i = 0; i < devices.size(); ++i) {
+            Data->DeviceNodes.insert(devices[i].devnode);
+        }
+        Data->HotplugActive = true;
+    } else {
+        CMN_LOG_CLASS_INIT_WARNING << "Configure: failed to monitor devices with udev" << std::endl;
+    }
 #endif
+    IsConnected = Data->Connected();
+#else
     IsConnected = true;
+#endif
 }
 
 
@@ -247,14 +1118,70 @@ void mts3Dconnexion::Startup(void)
     CMN_LOG_CLASS_INIT_VERBOSE << "SpaceNavigator is initialized" << std::endl;
 #endif
 
+#if (SAW_HAS_SPACENAV)
+    Data->ResetStatistics();
+    Data->Replay.SetRate(ReplayRate);
+    Data->Device.SetReplayRate(ReplayRate);
+    if (!RecordingFile.empty()) {
+        osa3DconnexionLog::Errno result = Data->Recorder.Create(RecordingFile);
+        if (Data->UseDevice) {
+            // the device logs its own raw events
+            Data->Recorder.Close();
+            result = (Data->Device.SetRecording(RecordingFile) == osa3Dconnexion::ESUCCESS) ?
+                osa3DconnexionLog::ESUCCESS : osa3DconnexionLog::EFAILURE;
+        }
+        if (result != osa3DconnexionLog::ESUCCESS) {
+            CMN_LOG_CLASS_INIT_ERROR << "Startup: failed to record " << RecordingFile << std::endl;
+        }
+    }
+    if (!SharedMemoryName.empty()
+        && (Data->Shm.Create(SharedMemoryName) != osa3DconnexionShm::ESUCCESS)) {
+        CMN_LOG_CLASS_INIT_ERROR << "Startup: failed to publish in shared memory " << SharedMemoryName << std::endl;
+    }
+    if (!StreamDestination.empty()
+        && (Data->Stream.OpenSender(StreamDestination) != osa3DconnexionUdp::ESUCCESS)) {
+        CMN_LOG_CLASS_INIT_ERROR << "Startup: failed to stream to " << StreamDestination << std::endl;
+    }
+    if (Data->UseGenerator) {
+        if (Data->Generator.Start(Data->Device, Data->Profile, osa3Dconnexion::EVDEV) != osa3DconnexionGenerator::ESUCCESS) {
+            CMN_LOG_CLASS_INIT_ERROR << "Startup: failed to start virtual device" << std::endl;
+            Data->NoDevice();
+        }
+        Data->DaemonConnected = Data->Device.IsConnected();
+    }
+    if (UseReaderThread && !Data->Replay.IsReplaying()) {
+        mts3DconnexionSample empty;
+        Data->Backpressure = Backpressure;
+        Data->Ring.SetSize(RingSize, empty);
+        Data->WakeupFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (EventDriven) {
+            Data->RingFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            Data->SignalRing = (Data->RingFD != -1);
+        }
+        if (Data->WakeupFD == -1) {
+            CMN_LOG_CLASS_INIT_ERROR << "Startup: failed to create wakeup channel for reader thread" << std::endl;
+        } else {
+            Data->ReaderRunning = true;
+            Data->ReaderThread.Create<mts3DconnexionData, mts3Dconnexion *>(Data, &mts3DconnexionData::Reader, this, "3DxReader");
+            CMN_LOG_CLASS_INIT_VERBOSE << "Startup: reader thread started with ring of size " << RingSize << std::endl;
+        }
+    }
+#endif
+
+#if (SAW_HAS_SPACENAV)
+    IsConnected = Data->Connected();
+#else
     IsConnected = true;
+#endif
     DataTable->Advance();
 }
 
 
 void mts3Dconnexion::Run(void)
 {
+    WaitForInput();
     ProcessQueuedCommands();
+    ProcessInput();
 
 #if (CISST_OS == CISST_WINDOWS)
     if (PeekMessage(&(Data->Msg), NULL, 0, 0, PM_REMOVE)) {
@@ -267,20 +1194,20 @@ void mts3Dconnexion::Run(void)
             Data->trans = Data->m_p3DSensor->GetTranslation();
             Data->rot = Data->m_p3DSensor->GetRotation();
             Data->rot->get_Angle(&angle);
-            Axis[0] = Data->trans->GetX();
-            Axis[1] = Data->trans->GetY();
-            Axis[2] = Data->trans->GetZ();
-            Axis[3] = Data->rot->GetX() * angle;
-            Axis[4] = Data->rot->GetY() * angle;
-            Axis[5] = Data->rot->GetZ() * angle;
+            State.Input[0] = Data->trans->GetX();
+            State.Input[1] = Data->trans->GetY();
+            State.Input[2] = Data->trans->GetZ();
+            State.Input[3] = Data->rot->GetX() * angle;
+            State.Input[4] = Data->rot->GetY() * angle;
+            State.Input[5] = Data->rot->GetZ() * angle;
         } catch (...) {
             CMN_LOG_CLASS_RUN_ERROR << "Caught exception" << std::endl;
         }
     }
     if (Data->m_p3DKeyboard) {
         try {
-            for (unsigned int i = 0; i < Buttons.size(); ++i) {
-                Buttons[i] = Data->m_p3DKeyboard->IsKeyDown(i+1) == VARIANT_TRUE;
+            for (unsigned int i = 0; i < StateType::NumButtons; ++i) {
+                State.SetButton(i, Data->m_p3DKeyboard->IsKeyDown(i+1) == VARIANT_TRUE);
             }
         } catch (...) {
             CMN_LOG_CLASS_RUN_ERROR << "Caught exception" << std::endl;
@@ -290,49 +1217,700 @@ void mts3Dconnexion::Run(void)
 #endif
 
 #if (SAW_HAS_SPACENAV)
-    //clean out all the samples in the state table.
-    while (spnav_poll_event(&Data->SpnavEvent) != 0) {
+    if (Data->ReaderRunning) {
+        // consume the ring in batches, copy each sample before releasing
+        // its slot
+        const size_t batchSize = osa3DconnexionSpacenav::BUFFERSIZE;
+        mts3DconnexionSample latest;
+        bool hasLatest = false;
+        size_t count = 0;
+        const mts3DconnexionSample * next;
+        while ((next = Data->Ring.Peek()) != 0) {
+            if ((Backpressure == KEEP_LATEST) && next->Motion) {
+                latest = *next;
+                hasLatest = true;
+            } else {
+                Data->Batch[count++] = *next;
+            }
+            Data->Ring.Get();
+            if (count == batchSize) {
+                ProcessSamples(Data->Batch, count);
+                count = 0;
+            }
+        }
+        if (hasLatest) {
+            Data->Batch[count++] = latest;
+        }
+        if (count != 0) {
+            ProcessSamples(Data->Batch, count);
+        } else {
+            UpdateIdle();
+        }
+        RingOccupancy = static_cast<unsigned int>(Data->Ring.GetAvailable());
+        RingOverflows = static_cast<unsigned int>(Data->Overflows);
+    } else {
+        if (!Data->UseDevice && !Data->Spacenav.IsOpened() && !Data->Replay.IsReplaying()) {
+            Data->Reconnect();
+        }
+        //clean out all the samples in the state table.
+        size_t count;
+        bool idle = true;
+        while ((count = Data->ReadSamples(0.0)) != 0) {
+            ProcessSamples(Data->Samples, count);
+            idle = false;
+        }
+        if (idle) {
+            UpdateIdle();
+        }
+        if (Data->UseDevice) {
+            Data->DaemonConnected = Data->Device.IsConnected();
+        } else {
+            Data->DaemonConnected = Data->Spacenav.IsOpened() || Data->Replay.IsReplaying();
+        }
+    }
+    UpdateConnection();
+#endif
+
+    UpdateMotionEvent();
+    UpdateStream(osaGetTime(), false);
+}
+
+
+void mts3Dconnexion::UpdateMotionEvent(void)
+{
+    // coalesce the motion since the last event
+    if (!MotionPending) {
+        return;
+    }
+    const double now = osaGetTime();
+    if ((MotionEventRate.Data > 0.0) && ((now - LastMotionEvent) < (1.0 / MotionEventRate.Data))) {
+        return;
+    }
+    MotionPending = false;
+    LastMotionEvent = now;
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        EventAxis[i] = State.Axis[i];
+    }
+    EventAxis.SetTimestamp(now);
+    MotionEvent(EventAxis);
+}
+
+
+void mts3Dconnexion::ButtonEvent(int button, bool pressed, double time)
+{
+    Data->PushEdge(button, pressed, time);
+    EventButton = button;
+    EventButton.SetTimestamp(time);
+    if (pressed) {
+        ButtonPressed(EventButton);
+    } else {
+        ButtonReleased(EventButton);
+    }
+}
+
+
+void mts3Dconnexion::UpdateConnection(void)
+{
+#if (SAW_HAS_SPACENAV)
+    bool connected = Data->Connected();
+    if (connected != IsConnected.Data) {
         DataTable->Start();
-        if(Data->SpnavEvent.type == SPNAV_EVENT_MOTION) {
-            //left handed coordinate system - fix it:
-            //X to the right (as looking at the sign)
-            //Y is down
-            //Z is back (towards cable)
-            Axis[0] = Data->SpnavEvent.motion.x;
-            Axis[1] = -Data->SpnavEvent.motion.y;
-            Axis[2] = Data->SpnavEvent.motion.z;
-            Axis[3] = Data->SpnavEvent.motion.rx;
-            Axis[4] = -Data->SpnavEvent.motion.ry;
-            Axis[5] = Data->SpnavEvent.motion.rz;
+        IsConnected = connected;
+        DataTable->Advance();
+        if (connected) {
+            CMN_LOG_CLASS_RUN_WARNING << "UpdateConnection: device connected" << std::endl;
+        } else {
+            CMN_LOG_CLASS_RUN_WARNING << "UpdateConnection: device disconnected" << std::endl;
+        }
+    }
+#endif
+}
+
+
+void mts3Dconnexion::ProcessSamples(mts3DconnexionSample * samples, size_t count)
+{
+    // mask and gain can be changed by commands, then transform all the
+    // axes at once
+    State.SetMaskAndGain(Mask, Gain.Data);
+    for (size_t i = 0; i < count; ++i) {
+        if (samples[i].Motion) {
+            Conditioning.Apply(samples[i].Axis, mts3DconnexionSampleTime(samples[i]));
+        }
+    }
+    State.Apply(samples, count);
+    for (size_t i = 0; i < count; ++i) {
+        ProcessSample(samples[i]);
+    }
+}
 
-            // the limits are +/- 350 for all inputs
 
+void mts3Dconnexion::ProcessSample(const mts3DconnexionSample & sample)
+{
+    // axes are already transformed, see ProcessSamples
+    DataTable->Start();
+    // integrate the axes held since the previous sample
+    State.Integrate(mts3DconnexionSampleTime(sample));
+    if (sample.Motion) {
+        for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+            State.Axis[i] = sample.Axis[i];
         }
-        else {	/* SPNAV_EVENT_BUTTON */
-            Buttons[Data->SpnavEvent.button.bnum] = Data->SpnavEvent.button.press;
+        MotionPending = true;
+    } else if ((sample.Button >= 0) && (sample.Button < static_cast<int>(StateType::NumButtons))) {
+        State.SetButton(sample.Button, sample.Pressed);
+        ButtonEvent(sample.Button, sample.Pressed, sample.Timestamp);
+    } else {
+        CMN_LOG_CLASS_RUN_WARNING << "ProcessSample: ignoring button " << sample.Button
+                                  << ", the device has " << StateType::NumButtons << " buttons" << std::endl;
+    }
+    CopyState(sample.Timestamp);
+    DataTable->Advance();
+#if (SAW_HAS_SPACENAV)
+    Data->Advanced(sample);
+#endif
+}
+
+
+void mts3Dconnexion::ProcessInput(void)
+{
+    if (Data->Input.GetVersion() == Data->InputVersion) {
+        return;
+    }
+    mts3DconnexionInput input;
+    Data->InputVersion = Data->Input.Read(input);
+    DataTable->Start();
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        State.Input[i] = input.Axis[i];
+    }
+    State.Buttons = input.Buttons;
+    UpdateDataTable();
+    DataTable->Advance();
+}
+
+
+void mts3Dconnexion::GetAxisData(mtsDoubleVec & axis) const
+{
+    mts3DconnexionOutput output;
+    Data->Output.Read(output);
+    // the size is only set once by the caller's first read
+    axis.SetSize(StateType::NumAxes);
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        axis[i] = output.Axis[i];
+    }
+    axis.SetTimestamp(output.Timestamp);
+#if (SAW_HAS_SPACENAV)
+    Data->ConsumerRead();
+#endif
+}
+
+
+void mts3Dconnexion::GetPositionCartesian(prmPositionCartesianGet & position) const
+{
+    mts3DconnexionOutput output;
+    Data->Output.Read(output);
+    for (unsigned int i = 0; i < 3; ++i) {
+        position.Position().Translation()[i] = output.Translation[i];
+        for (unsigned int j = 0; j < 3; ++j) {
+            position.Position().Rotation().Element(i, j) = output.Rotation[3 * i + j];
         }
-        UpdateDataTable();
-        DataTable->Advance();
     }
+    position.SetTimestamp(output.Timestamp);
+    position.SetValid(true);
+#if (SAW_HAS_SPACENAV)
+    Data->ConsumerRead();
 #endif
 }
 
+
+void mts3Dconnexion::GetButtonEdgesSince(const mtsULong & index, mtsDoubleMat & edges) const
+{
+    Data->EdgesMutex.Lock();
+    // edges older than the queue are lost, start from the oldest
+    const unsigned long long size = mts3DconnexionData::EDGES;
+    const unsigned long long next = Data->EdgesNext;
+    unsigned long long first = index.Data;
+    if ((first < next) && (next - first > size)) {
+        first = next - size;
+    }
+    const size_t count = (first < next) ? static_cast<size_t>(next - first) : 0;
+    edges.SetSize(count, EDGE_SIZE);
+    for (size_t i = 0; i < count; ++i) {
+        const mts3DconnexionEdge & edge = Data->Edges[(first + i) % size];
+        edges.Element(i, EDGE_INDEX) = static_cast<double>(first + i);
+        edges.Element(i, EDGE_BUTTON) = edge.Button;
+        edges.Element(i, EDGE_PRESSED) = edge.Pressed ? 1.0 : 0.0;
+        edges.Element(i, EDGE_TIMESTAMP) = edge.Timestamp;
+    }
+    Data->EdgesMutex.Unlock();
+}
+
+
+void mts3Dconnexion::GetAxisHistorySince(const mtsULong & index, mtsDoubleMat & records) const
+{
+    Data->HistoryMutex.Lock();
+    // records older than the history are lost, start from the oldest
+    const unsigned long long size = Data->History.size();
+    const unsigned long long next = Data->HistoryNext;
+    unsigned long long first = index.Data;
+    if ((first < next) && (next - first > size)) {
+        first = next - size;
+    }
+    const size_t count = (first < next) ? static_cast<size_t>(next - first) : 0;
+    records.SetSize(count, HISTORY_SIZE);
+    for (size_t i = 0; i < count; ++i) {
+        const mts3DconnexionRecord & record = Data->History[(first + i) % size];
+        records.Element(i, HISTORY_INDEX) = static_cast<double>(first + i);
+        records.Element(i, HISTORY_TIMESTAMP) = record.Timestamp;
+        for (unsigned int j = 0; j < StateType::NumAxes; ++j) {
+            records.Element(i, HISTORY_AXIS + j) = record.Axis[j];
+        }
+        records.Element(i, HISTORY_BUTTONS) = record.Buttons;
+    }
+    Data->HistoryMutex.Unlock();
+}
+
+
+void mts3Dconnexion::GetLatencyStatistics(mtsDoubleVec & statistics) const
+{
+    statistics.SetSize(LATENCY_STATISTICS_SIZE);
+    statistics.SetAll(0.0);
+#if (SAW_HAS_SPACENAV)
+    const osa3DconnexionHistogram * histograms[3] = {&(Data->ReadLatency),
+                                                     &(Data->AdvanceLatency),
+                                                     &(Data->ConsumerLatency)};
+    for (size_t i = 0; i < 3; ++i) {
+        statistics[3 * i] = histograms[i]->GetPercentile(0.5) * cmn_us;
+        statistics[3 * i + 1] = histograms[i]->GetPercentile(0.99) * cmn_us;
+        statistics[3 * i + 2] = histograms[i]->GetMax() * cmn_us;
+    }
+    const double elapsed = (osa3DconnexionLog::Now() - Data->StatisticsStart) * cmn_us;
+    if (elapsed > 0.0) {
+        statistics[MOTION_RATE] = Data->MotionSamples / elapsed;
+        statistics[BUTTON_RATE] = Data->ButtonSamples / elapsed;
+    }
+#endif
+}
+
+
+void mts3Dconnexion::ResetLatencyStatistics(void)
+{
+#if (SAW_HAS_SPACENAV)
+    Data->ResetStatistics();
+#endif
+}
+
+
 void mts3Dconnexion::UpdateDataTable(void)
 {
-    // apply mask and gain to axis data
-    for (unsigned int i = 0; i < Axis.size(); ++i) {
-        if (Mask[i]) {
-            Axis[i] *= Gain;
+    // condition, transform, mask and gain the axes read and accumulate
+    // applied force to provide an absolute Cartesian position
+    State.SetMaskAndGain(Mask, Gain.Data);
+    // Input keeps the raw counts, the device may not report them again
+    const StateType::AxisType input(State.Input);
+    const double time = osaGetTime();
+    const bool wasMoving = State.IsMoving();
+    Conditioning.Apply(State.Input.Pointer(), time);
+    State.Update(time);
+    State.Input = input;
+    // report the motion until the axes are back to 0
+    MotionPending = MotionPending || wasMoving || State.IsMoving();
+    // the buttons are polled, report the changes
+    const StateType::ButtonsType changed = State.Buttons ^ EventButtons;
+    if (changed) {
+        EventButtons = State.Buttons;
+        for (unsigned int i = 0; i < StateType::NumButtons; ++i) {
+            if (changed & (1u << i)) {
+                ButtonEvent(i, State.GetButton(i), time);
+            }
+        }
+    }
+    CopyState(time);
+}
+
+
+void mts3Dconnexion::UpdateIdle(void)
+{
+#if (SAW_HAS_SPACENAV)
+    // the device only reports changes, keep integrating the axes held,
+    // estimating the bias and filtering the last counts while the device
+    // is idle so the filtered axes reach them
+    // conditioning and integration on the clock of the samples
+    const double time = osaGetTime();
+    const double now = mts3DconnexionNow();
+    const bool rebiased = Conditioning.Update(now);
+    const bool settled = Conditioning.IsSettled();
+    if (!rebiased && settled && !State.IsMoving()) {
+        return;
+    }
+    DataTable->Start();
+    State.Integrate(now);
+    if (rebiased || !settled) {
+        mts3DconnexionSample sample;
+        sample.Motion = true;
+        sample.Timestamp = time;
+        for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+            sample.Axis[i] = Conditioning.GetRaw()[i];
+        }
+        Conditioning.Apply(sample.Axis, now);
+        State.Apply(&sample, 1);
+        for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+            State.Axis[i] = sample.Axis[i];
+        }
+    }
+    CopyState(time);
+    DataTable->Advance();
+    MotionPending = true;
+#endif
+}
+
+
+void mts3Dconnexion::ParseOptions(const std::string & options)
+{
+    // i.e. "deadzone=20,curve=2,filter=oneeuro,cutoff=1,beta=0.01"
+    ConditioningType::FilterType filter = Conditioning.GetFilter();
+    double cutoff = Conditioning.GetCutoff();
+    double beta = Conditioning.GetBeta();
+    double derivativeCutoff = Conditioning.GetDerivativeCutoff();
+    std::stringstream stream(options);
+    std::string option;
+    while (std::getline(stream, option, ',')) {
+        const size_t equal = option.find('=');
+        const std::string key = option.substr(0, equal);
+        const std::string value = (equal == std::string::npos) ? "" : option.substr(equal + 1);
+        const double number = atof(value.c_str());
+        if (key == "range") {
+            Conditioning.SetRange(atoi(value.c_str()));
+        } else if (key == "deadzone") {
+            // one value for all the axes or one per axis separated by ':'
+            StateType::AxisType deadzone(number);
+            std::stringstream values(value);
+            std::string element;
+            for (unsigned int i = 0; (i < StateType::NumAxes) && std::getline(values, element, ':'); ++i) {
+                deadzone[i] = atof(element.c_str());
+            }
+            if (value.find(':') == std::string::npos) {
+                deadzone.SetAll(number);
+            }
+            Conditioning.SetDeadzone(deadzone);
+        } else if (key == "curve") {
+            Conditioning.SetExponent(number);
+        } else if (key == "filter") {
+            if (value == "none") {
+                filter = ConditioningType::NONE;
+            } else if (value == "lowpass") {
+                filter = ConditioningType::LOW_PASS;
+            } else if (value == "oneeuro") {
+                filter = ConditioningType::ONE_EURO;
+            } else {
+                CMN_LOG_CLASS_INIT_WARNING << "Configure: unknown filter " << value << std::endl;
+            }
+        } else if (key == "cutoff") {
+            cutoff = number;
+        } else if (key == "beta") {
+            beta = number;
+        } else if (key == "dcutoff") {
+            derivativeCutoff = number;
+        } else if ((key == "vscale") || (key == "vmax")) {
+            // translation and rotation, the same for both by default
+            const size_t colon = value.find(':');
+            const double rotation = (colon == std::string::npos) ? number : atof(value.c_str() + colon + 1);
+            if (key == "vscale") {
+                State.SetVelocityScale(number, rotation);
+            } else {
+                State.SetVelocityLimits(number, rotation);
+            }
+        } else if (key == "eventrate") {
+            MotionEventRate = (number > 0.0) ? number : 0.0;
+        } else if (key == "biaswindow") {
+            Conditioning.SetBiasWindow(number);
+        } else if (key == "drift") {
+            // time constant, optionally followed by threshold and rest time
+            double drift[3] = {number, Conditioning.GetDriftThreshold(), Conditioning.GetDriftRestTime()};
+            std::stringstream values(value);
+            std::string element;
+            for (size_t i = 0; (i < 3) && std::getline(values, element, ':'); ++i) {
+                drift[i] = atof(element.c_str());
+            }
+            Conditioning.SetDriftCompensation(drift[0], drift[1], drift[2]);
         } else {
-            Axis[i] = 0.0;
+            CMN_LOG_CLASS_INIT_WARNING << "Configure: unknown option " << option << std::endl;
+        }
+    }
+    Conditioning.SetFilter(filter, cutoff, beta, derivativeCutoff);
+}
+
+
+void mts3Dconnexion::CopySettings(void)
+{
+    CountRange = Conditioning.GetRange();
+    Deadzone.SetSize(StateType::NumAxes);
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        Deadzone[i] = Conditioning.GetDeadzone()[i];
+    }
+    ResponseExponent = Conditioning.GetExponent();
+    Filter.SetSize(FILTER_SIZE);
+    Filter[FILTER_TYPE] = Conditioning.GetFilter();
+    Filter[FILTER_CUTOFF] = Conditioning.GetCutoff();
+    Filter[FILTER_BETA] = Conditioning.GetBeta();
+    Filter[FILTER_DERIVATIVE_CUTOFF] = Conditioning.GetDerivativeCutoff();
+    VelocityScale.SetSize(2);
+    VelocityScale[0] = State.TranslationScale;
+    VelocityScale[1] = State.RotationScale;
+    VelocityLimits.SetSize(2);
+    VelocityLimits[0] = State.MaxTranslation;
+    VelocityLimits[1] = State.MaxRotation;
+    Bias.SetSize(StateType::NumAxes);
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        Bias[i] = Conditioning.GetBias()[i];
+    }
+    BiasWindow = Conditioning.GetBiasWindow();
+    DriftCompensation.SetSize(3);
+    DriftCompensation[0] = Conditioning.GetDriftTimeConstant();
+    DriftCompensation[1] = Conditioning.GetDriftThreshold();
+    DriftCompensation[2] = Conditioning.GetDriftRestTime();
+}
+
+
+void mts3Dconnexion::SetCountRange(const mtsInt & range)
+{
+    Conditioning.SetRange(range.Data);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetDeadzone(const mtsDoubleVec & deadzone)
+{
+    if (deadzone.size() != StateType::NumAxes) {
+        CMN_LOG_CLASS_RUN_ERROR << "SetDeadzone: expected " << StateType::NumAxes << " axes" << std::endl;
+        return;
+    }
+    Conditioning.SetDeadzone(deadzone);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetResponseExponent(const mtsDouble & exponent)
+{
+    Conditioning.SetExponent(exponent.Data);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetFilter(const mtsDoubleVec & filter)
+{
+    if ((filter.size() != FILTER_SIZE)
+        || (filter[FILTER_TYPE] < ConditioningType::NONE)
+        || (filter[FILTER_TYPE] > ConditioningType::ONE_EURO)) {
+        CMN_LOG_CLASS_RUN_ERROR << "SetFilter: expected type (0 none, 1 low-pass, 2 One-Euro), cutoff, beta and derivative cutoff" << std::endl;
+        return;
+    }
+    Conditioning.SetFilter(static_cast<ConditioningType::FilterType>(static_cast<int>(filter[FILTER_TYPE])),
+                           filter[FILTER_CUTOFF], filter[FILTER_BETA], filter[FILTER_DERIVATIVE_CUTOFF]);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetVelocityScale(const mtsDoubleVec & scale)
+{
+    if (scale.size() != 2) {
+        CMN_LOG_CLASS_RUN_ERROR << "SetVelocityScale: expected translation and rotation scales" << std::endl;
+        return;
+    }
+    State.SetVelocityScale(scale[0], scale[1]);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetVelocityLimits(const mtsDoubleVec & limits)
+{
+    if (limits.size() != 2) {
+        CMN_LOG_CLASS_RUN_ERROR << "SetVelocityLimits: expected translation and rotation limits" << std::endl;
+        return;
+    }
+    State.SetVelocityLimits(limits[0], limits[1]);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::ReBias(void)
+{
+    // the mean is computed by Run from the samples received meanwhile
+    Conditioning.StartBias(mts3DconnexionNow());
+    CMN_LOG_CLASS_RUN_VERBOSE << "ReBias: computing bias over " << Conditioning.GetBiasWindow() << "s" << std::endl;
+}
+
+
+void mts3Dconnexion::SetBiasWindow(const mtsDouble & window)
+{
+    Conditioning.SetBiasWindow(window.Data);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetDriftCompensation(const mtsDoubleVec & drift)
+{
+    if (drift.size() != 3) {
+        CMN_LOG_CLASS_RUN_ERROR << "SetDriftCompensation: expected time constant, threshold and rest time" << std::endl;
+        return;
+    }
+    Conditioning.SetDriftCompensation(drift[0], drift[1], drift[2]);
+    CopySettings();
+}
+
+
+void mts3Dconnexion::SetMotionEventRate(const mtsDouble & rate)
+{
+    MotionEventRate = (rate.Data > 0.0) ? rate.Data : 0.0;
+}
+
+
+void mts3Dconnexion::CopyState(double time)
+{
+    // history ring, the oldest record is overwritten
+    Data->HistoryMutex.Lock();
+    mts3DconnexionRecord & record = Data->History[Data->HistoryNext % Data->History.size()];
+    record.Timestamp = time;
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        record.Axis[i] = State.Axis[i];
+    }
+    record.Buttons = State.Buttons;
+    ++(Data->HistoryNext);
+    Data->HistoryMutex.Unlock();
+
+    // state table vectors are sized in Configure
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        Axis[i] = State.Axis[i];
+    }
+    for (unsigned int i = 0; i < StateType::NumButtons; ++i) {
+        Buttons[i] = State.GetButton(i);
+    }
+    ButtonMask = State.Buttons;
+    Position.Position().Translation().Assign(State.Translation);
+    Position.Position().Rotation().From(vctEulerZYXRotation3(State.Orientation));
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        Bias[i] = Conditioning.GetBias()[i];
+    }
+
+    mts3DconnexionOutput output;
+    output.Timestamp = time;
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        output.Axis[i] = State.Axis[i];
+    }
+    for (unsigned int i = 0; i < 3; ++i) {
+        output.Translation[i] = State.Translation[i];
+        for (unsigned int j = 0; j < 3; ++j) {
+            output.Rotation[3 * i + j] = Position.Position().Rotation().Element(i, j);
         }
     }
+    Data->Output.Write(output);
 
-    // accumulate applied force to provide an absolute Cartesian position
+#if (SAW_HAS_SPACENAV)
+    if (Data->Shm.IsOpened()) {
+        saw3DconnexionShmSample sample;
+        for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+            sample.axis[i] = output.Axis[i];
+        }
+        sample.buttons = State.Buttons;
+        sample.connected = IsConnected.Data ? 1 : 0;
+        for (unsigned int i = 0; i < 3; ++i) {
+            sample.translation[i] = output.Translation[i];
+        }
+        for (unsigned int i = 0; i < 9; ++i) {
+            sample.rotation[i] = output.Rotation[i];
+        }
+        Data->Shm.Publish(sample);
+    }
+#endif
+    UpdateStream(time, true);
+}
+
+
+void mts3Dconnexion::UpdateStream(double time, bool advanced)
+{
+#if (SAW_HAS_SPACENAV)
+    if (!Data->Stream.IsOpened()) {
+        return;
+    }
+    // idle packets while nothing changes, at least every keep alive
+    const double keepAlive = 0.1;
+    // sample packets repeated after a change and at least every keyframe
+    // so a receiver recovers from lost packets
+    const unsigned int repeats = 3;
+    const double keyframe = 1.0;
+
+    osa3DconnexionUdp::Packet packet;
+    packet.type = osa3DconnexionUdp::Packet::SAMPLE;
+    packet.utimestamp = static_cast<long long>(time / cmn_us);
+    packet.connected = IsConnected.Data;
+    packet.base = 0;
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        packet.axis[i] = static_cast<float>(State.Axis[i]);
+    }
+    packet.buttons = State.Buttons;
+    for (unsigned int i = 0; i < 3; ++i) {
+        packet.translation[i] = State.Translation[i];
+        packet.orientation[i] = State.Orientation[i];
+    }
+
+    const osa3DconnexionUdp::Packet & last = Data->StreamSample;
+    bool changed = !Data->StreamStarted
+        || (packet.connected != last.connected)
+        || (packet.buttons != last.buttons);
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        changed = changed || (packet.axis[i] != last.axis[i]);
+    }
     for (unsigned int i = 0; i < 3; ++i) {
-        Translation[i] += Axis[i];
-        Orientation[i] += Axis[i+3];
+        changed = changed
+            || (packet.translation[i] != last.translation[i])
+            || (packet.orientation[i] != last.orientation[i]);
+    }
+
+    if (changed) {
+        Data->StreamRepeats = 0;
+    } else if (!advanced && (time - Data->StreamLastSent < keepAlive)) {
+        return;
+    }
+    if (changed
+        || (Data->StreamRepeats < repeats)
+        || (time - Data->StreamLastSample >= keyframe)) {
+        Data->Stream.Send(packet);
+        Data->StreamSample = packet;
+        Data->StreamStarted = true;
+        ++(Data->StreamRepeats);
+        Data->StreamLastSample = time;
+    } else {
+        packet.type = osa3DconnexionUdp::Packet::IDLE;
+        packet.base = last.sequence;
+        Data->Stream.Send(packet);
+    }
+    Data->StreamLastSent = time;
+#endif
+}
+
+
+void mts3Dconnexion::SetAxisTransform(const mtsDoubleMat & transform)
+{
+    if ((transform.rows() != StateType::NumAxes) || (transform.cols() != StateType::NumAxes)) {
+        CMN_LOG_CLASS_RUN_ERROR << "SetAxisTransform: transform must be "
+                                << StateType::NumAxes << "x" << StateType::NumAxes << std::endl;
+        return;
+    }
+    AxisTransform = transform;
+    UpdateTransform();
+}
+
+
+void mts3Dconnexion::UpdateTransform(void)
+{
+    // robot axes from the component axes from the device axes
+    StateType::TransformType transform;
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        for (unsigned int j = 0; j < StateType::NumAxes; ++j) {
+            double element = 0.0;
+            for (unsigned int k = 0; k < StateType::NumAxes; ++k) {
+                element += AxisTransform.Element(i, k) * DeviceTransform.Element(k, j);
+            }
+            transform.Element(i, j) = element;
+        }
     }
-    Position.Position().Translation().Assign(Translation);
-    Position.Position().Rotation().From(vctEulerZYXRotation3(Orientation));
+    State.SetTransform(transform);
 }
@@ -0,0 +1,186 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <cisstCommon/cmnUnits.h>
+#include <cisstOSAbstraction/osaGetTime.h>
+#include <cisstOSAbstraction/osaSleep.h>
+#include <cisstMultiTask/mtsInterfaceProvided.h>
+#include <saw3Dconnexion/mts3DconnexionReceiver.h>
+
+CMN_IMPLEMENT_SERVICES_DERIVED_ONEARG(mts3DconnexionReceiver, mtsTaskContinuous, mtsTaskPeriodicConstructorArg);
+
+
+void mts3DconnexionReceiver::Init(void)
+{
+    Base = 0;
+    HasBase = false;
+    Unsynchronized = 0;
+    LastReceived = 0.0;
+    // the sender sends a packet at least every 100 ms
+    Timeout = 0.5;
+}
+
+
+void mts3DconnexionReceiver::Configure(const std::string & address)
+{
+    Address = address;
+    Axis.SetSize(StateType::NumAxes);
+    Axis.SetAll(0.0);
+    Buttons.SetSize(StateType::NumButtons);
+    Buttons.SetAll(false);
+    ButtonMask = 0;
+    IsConnected = false;
+    SourceTime = 0.0;
+    EventAxis.SetSize(StateType::NumAxes);
+    EventAxis.SetAll(0.0);
+    EventButton = 0;
+
+    // the state table is advanced after each Run
+    StateTable.AddData(Axis, "AxisData");
+    StateTable.AddData(Buttons, "ButtonData");
+    StateTable.AddData(ButtonMask, "ButtonMask");
+    StateTable.AddData(Position, "Position");
+    StateTable.AddData(IsConnected, "IsConnected");
+    StateTable.AddData(SourceTime, "SourceTime");
+
+    mtsInterfaceProvided * providesSpaceNavigator = AddInterfaceProvided("ProvidesSpaceNavigator");
+    if (providesSpaceNavigator) {
+        providesSpaceNavigator->AddCommandReadState(StateTable, Axis, "GetAxisData");
+        providesSpaceNavigator->AddCommandReadState(StateTable, Buttons, "GetButtonData");
+        providesSpaceNavigator->AddCommandReadState(StateTable, ButtonMask, "GetButtonMask");
+        providesSpaceNavigator->AddCommandReadState(StateTable, Position, "GetPositionCartesian");
+        providesSpaceNavigator->AddCommandReadState(StateTable, IsConnected, "GetIsConnected");
+        providesSpaceNavigator->AddCommandReadState(StateTable, SourceTime, "GetSourceTime");
+        // events, the payloads are timestamped with the local time of
+        // reception, the sender time is provided by GetSourceTime
+        providesSpaceNavigator->AddEventWrite(MotionEvent, "MotionEvent", EventAxis);
+        providesSpaceNavigator->AddEventWrite(ButtonPressed, "ButtonPressed", EventButton);
+        providesSpaceNavigator->AddEventWrite(ButtonReleased, "ButtonReleased", EventButton);
+        providesSpaceNavigator->AddCommandRead(&mts3DconnexionReceiver::GetStreamStatistics, this, "GetStreamStatistics");
+        providesSpaceNavigator->AddCommandVoid(&mts3DconnexionReceiver::ResetStreamStatistics, this, "ResetStreamStatistics");
+    }
+}
+
+
+void mts3DconnexionReceiver::Startup(void)
+{
+    if (Socket.OpenReceiver(Address) != osa3DconnexionUdp::ESUCCESS) {
+        CMN_LOG_CLASS_INIT_ERROR << "Startup: failed to receive on " << Address << std::endl;
+    }
+}
+
+
+void mts3DconnexionReceiver::Run(void)
+{
+    // sleep on the socket, at most one period
+    const size_t count = Socket.Receive(Packets, osa3DconnexionUdp::BUFFERSIZE,
+                                        Socket.IsOpened() ? Period : 0.0);
+    if (!Socket.IsOpened()) {
+        osaSleep(Period);
+    }
+    ProcessQueuedCommands();
+
+    const double now = osaGetTime();
+    bool moved = false;
+    for (size_t i = 0; i < count; ++i) {
+        const osa3DconnexionUdp::Packet & packet = Packets[i];
+        LastReceived = now;
+        SourceTime = packet.utimestamp * cmn_us;
+        IsConnected = packet.connected;
+        if (packet.type == osa3DconnexionUdp::Packet::IDLE) {
+            // the state is unchanged since the sample packet base
+            if (!HasBase || (packet.base != Base)) {
+                ++Unsynchronized;
+            }
+            continue;
+        }
+        Base = packet.sequence;
+        HasBase = true;
+        for (unsigned int j = 0; j < StateType::NumAxes; ++j) {
+            moved = moved || (Axis[j] != packet.axis[j]);
+        }
+        ProcessPacket(packet, now);
+    }
+    if (now - LastReceived > Timeout) {
+        IsConnected = false;
+    }
+
+    if (moved) {
+        EventAxis.Assign(Axis);
+        EventAxis.SetTimestamp(now);
+        MotionEvent(EventAxis);
+    }
+}
+
+
+void mts3DconnexionReceiver::ProcessPacket(const osa3DconnexionUdp::Packet & packet, double time)
+{
+    for (unsigned int i = 0; i < StateType::NumAxes; ++i) {
+        Axis[i] = packet.axis[i];
+    }
+    // trigger the button events in order
+    const unsigned int changed = packet.buttons ^ ButtonMask.Data;
+    for (unsigned int i = 0; i < StateType::NumButtons; ++i) {
+        const bool pressed = (packet.buttons & (1u << i)) != 0;
+        Buttons[i] = pressed;
+        if (changed & (1u << i)) {
+            EventButton = i;
+            EventButton.SetTimestamp(time);
+            if (pressed) {
+                ButtonPressed(EventButton);
+            } else {
+                ButtonReleased(EventButton);
+            }
+        }
+    }
+    ButtonMask = packet.buttons;
+    vct3 orientation;
+    for (unsigned int i = 0; i < 3; ++i) {
+        Position.Position().Translation()[i] = packet.translation[i];
+        orientation[i] = packet.orientation[i];
+    }
+    Position.Position().Rotation().From(vctEulerZYXRotation3(orientation));
+}
+
+
+void mts3DconnexionReceiver::Cleanup(void)
+{
+    Socket.Close();
+}
+
+
+void mts3DconnexionReceiver::GetStreamStatistics(mtsDoubleVec & statistics) const
+{
+    const osa3DconnexionUdp::Statistics & stream = Socket.GetStatistics();
+    statistics.SetSize(STREAM_SIZE);
+    statistics[STREAM_RECEIVED] = static_cast<double>(stream.received);
+    statistics[STREAM_LOST] = static_cast<double>(stream.lost);
+    statistics[STREAM_REORDERED] = static_cast<double>(stream.reordered);
+    statistics[STREAM_DUPLICATED] = static_cast<double>(stream.duplicated);
+    statistics[STREAM_INVALID] = static_cast<double>(stream.invalid);
+    statistics[STREAM_UNSYNCHRONIZED] = static_cast<double>(Unsynchronized);
+}
+
+
+void mts3DconnexionReceiver::ResetStreamStatistics(void)
+{
+    Socket.ResetStatistics();
+    Unsynchronized = 0;
+}
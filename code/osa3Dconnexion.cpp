@@ -21,13 +21,29 @@ http://www.cisst.org/cisst/license.txt.
 
 #include <cisstCommon/cmnAssert.h>
 #include <cisstCommon/cmnLogger.h>
+#include <saw3DconnexionConfig.h>
 
 #if (CISST_OS == CISST_LINUX)
 #include <string.h>           // for memset
+#include <errno.h>            // for errno/EAGAIN
+#include <math.h>             // for ceil
+#include <time.h>             // for clock_gettime
 #include <fcntl.h>            // for open/close read/write O_RDWR
-#include <libgen.h>           // for basename/dirname 
-#include <dirent.h>           // for opendir/closedir
+#include <poll.h>             // for poll
+#include <unistd.h>           // for access
+#include <stdint.h>           // for uint64_t
+#include <sys/eventfd.h>      // for eventfd (wakeup channel)
+#include <sys/ioctl.h>        // for ioctl
+#include <stdlib.h>           // for strtoul
+#include <dirent.h>           // for opendir/readdir/closedir
+#include <fstream>            // for sysfs attributes
+#include <sstream>
 #include <linux/joystick.h>   // for joystick event
+#include <linux/input.h>      // for evdev event
+#include <saw3Dconnexion/osa3DconnexionLog.h>
+#if (SAW_HAS_UDEV)
+#include <saw3Dconnexion/osa3DconnexionHotplug.h>
+#endif
 #else
 #endif
 
@@ -35,17 +51,788 @@ http://www.cisst.org/cisst/license.txt.
 struct osa3Dconnexion::Internals{
 
 #if (CISST_OS == CISST_LINUX)
+    enum { BUFFERSIZE = 64 };     // maximum number of events read at once
+    enum { PERROR, PTIMEOUT, PDATA, PINTERRUPT, PHANGUP, PHOTPLUG };
+    osa3Dconnexion* self;    // to reopen the device
+    osa3Dconnexion::Backend backend; // interface used to read data
+    std::string filename;    // device opened by the user (empty once closed)
     std::string inputfn;     // input filename (i.e. /dev/input/js?)
     std::string eventfn;     // event filename (i.e. /dev/input/event?)
     int inputfd;             // file descriptor for input device (data)
-    int eventfd;             // file descriptor for event device (LED)
+    int eventfd;             // file descriptor for event device (LED/data)
+    int wakeupfd;            // eventfd used to interrupt a waiting reader
     long long data[6];       // state of the device (events are per axis)
+    long long values[6];     // last value reported by each axis
+    long long reported[6];   // data at the last evdev report
+    unsigned int buttons;    // bitmask of the buttons pressed
+    struct js_event jsbuffer[BUFFERSIZE];    // raw joystick events
+    struct input_event evbuffer[BUFFERSIZE]; // raw evdev events
+    size_t partial;          // bytes of a raw event cut short (streams)
+    bool virtualdevice;      // raw events from a FIFO, pipe or socket
+
+    bool coalesce;           // one motion event per device report
+    bool pending;            // axes changed since the last motion event
+    bool drained;            // no more raw events queued after pending
+    bool dropped;            // the kernel dropped evdev events
+    osa3Dconnexion::Event resync[3];   // button edges and motion after a drop
+    size_t resynchead;       // next resynchronization event
+    size_t resynccount;      // number of resynchronization events
+    unsigned int pendingtime;          // joystick time of the pending report
+    long long jsoffset;      // monotonic minus joystick time (us)
+    bool jsmapped;           // jsoffset was estimated
+
+    // Estimate the offset of the joystick clock (jiffies) with the
+    // smallest delay between the event time and the read time
+    void Map( const struct js_event* e, size_t count );
+
+    osa3Dconnexion::Event queue[BUFFERSIZE]; // decoded events for WaitForEvent
+    size_t queuehead;        // next event in the queue
+    size_t queuecount;       // number of events in the queue
+
+    bool hotplug;            // reopen the device when it is plugged back
+    bool invalid;            // reading without a device was reported
+    double lastretry;        // last attempt to reopen the device
+#if (SAW_HAS_UDEV)
+    osa3DconnexionHotplug monitor;  // udev notifications
+#endif
+
+    osa3DconnexionLog recorder;     // log of the raw events read
+    osa3DconnexionLog replay;       // log replayed by the REPLAY backend
+    osa3DconnexionLog::Record records[BUFFERSIZE]; // raw events to log
+
+    // file descriptor used to read data (-1 for REPLAY)
+    int DataFD() const
+    { return ( backend == osa3Dconnexion::EVDEV ) ? eventfd : inputfd; }
+
+    // Wait until the data is readable, the wakeup channel is signaled, the
+    // device is unplugged (PHANGUP) or udev reports a device (PHOTPLUG). A
+    // negative timeout blocks indefinitely.
+    int Poll( double timeout );
+
+    // Read and decode the queued raw events
+    size_t Drain( osa3Dconnexion::Event* events, size_t maxevents );
+
+    // Replay the raw events of the log that are due
+    size_t Replay( osa3Dconnexion::Event* events,
+                   size_t maxevents,
+                   double timeout );
+
+    // Append the raw events to the recorder
+    void Record( const struct js_event* e, size_t count );
+    void Record( const struct input_event* e, size_t count );
+
+    // Reset the device state before opening
+    void Reset( osa3Dconnexion::Backend backend, const std::string& filename );
+
+    // Close the file descriptors of an unplugged device
+    void Disconnect();
+
+    // Open the device again if the node is available
+    void Reopen( const std::string& devnode );
+
+    // Process the udev notifications
+    void Hotplug();
+
+    // Read and decode at most maxevents raw events. Raw events that do not
+    // produce an event (i.e. SYN_REPORT) are skipped and the read is retried
+    // until the timeout expires.
+    size_t Read( osa3Dconnexion::Event* events,
+                 size_t maxevents,
+                 double timeout );
+
+    // Convert a raw event to a device event and update the device state.
+    // Return true if the raw event produced an event.
+    bool Decode( const struct js_event& e, osa3Dconnexion::Event& event );
+    bool Decode( const struct input_event& e, osa3Dconnexion::Event& event );
+
+    // Copy the device state to an event
+    void Copy( osa3Dconnexion::Event& event ) const;
+
+    // Produce the motion event of the pending joystick report
+    void Flush( osa3Dconnexion::Event& event );
+
+    // Query the initial axes and buttons state of the evdev device
+    void InitializeState();
+
+    // Query the axes and buttons of the evdev device, return a bitmask of
+    // the axes queried
+    unsigned int QueryState();
+
+    // Query the state after dropped events and queue the button edges
+    // lost and a motion event with the state
+    void Resynchronize( long long utimestamp );
+
+    // Move the queued resynchronization events to events
+    size_t Resynced( osa3Dconnexion::Event* events, size_t maxevents );
 #else
 #endif
 
 };
 
 
+#if (CISST_OS == CISST_LINUX)
+
+// monotonic time in seconds
+static double osa3DconnexionNow(){
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// period used to retry opening an unplugged device without udev
+static const double osa3DconnexionRetryPeriod = 0.5;
+
+int osa3Dconnexion::Internals::Poll( double timeout ){
+
+    int ms = -1;
+    if( 0.0 <= timeout )
+        { ms = static_cast<int>( ceil( timeout * 1000.0 ) ); }
+
+    // negative file descriptors are ignored by poll
+    struct pollfd pfd[3];
+    pfd[0].fd = DataFD();
+    pfd[1].fd = wakeupfd;
+    pfd[2].fd = -1;
+#if (SAW_HAS_UDEV)
+    if( hotplug )
+        { pfd[2].fd = monitor.GetFileDescriptor(); }
+#endif
+    for( size_t i=0; i<3; i++ ){
+        pfd[i].events = POLLIN;
+        pfd[i].revents = 0;
+    }
+
+    int result = poll( pfd, 3, ms );
+    while( result == -1 && errno == EINTR )
+        { result = poll( pfd, 3, ms ); }
+
+    if( result == -1 ){ return PERROR; }
+    if( result == 0 ) { return PTIMEOUT; }
+
+    // consume the wakeup so the next wait blocks again
+    if( pfd[1].revents & POLLIN ){
+        uint64_t count;
+        if( read( wakeupfd, &count, sizeof(count) ) == -1 && errno != EAGAIN )
+            { return PERROR; }
+        return PINTERRUPT;
+    }
+
+    // read the remaining data before reporting a hangup
+    if( pfd[0].revents & POLLIN )                 { return PDATA; }
+    if( pfd[0].revents & ( POLLERR | POLLHUP ) )  { return PHANGUP; }
+    if( pfd[2].revents & POLLIN )                 { return PHOTPLUG; }
+    return PERROR;
+
+}
+
+void osa3Dconnexion::Internals::Disconnect(){
+
+    if( inputfd != -1 ){
+        close( inputfd );
+        inputfd = -1;
+    }
+    if( eventfd != -1 ){
+        close( eventfd );
+        eventfd = -1;
+    }
+    pending = false;
+    drained = false;
+    CMN_LOG_RUN_WARNING << "Device disconnected" << std::endl;
+
+}
+
+void osa3Dconnexion::Internals::Reopen( const std::string& devnode ){
+
+    // don't reopen a device closed by the user
+    if( filename.empty() || access( devnode.c_str(), R_OK ) != 0 )
+        { return; }
+
+    if( self->Open( devnode, backend ) == osa3Dconnexion::ESUCCESS && DataFD() != -1 )
+        { CMN_LOG_RUN_WARNING << "Device reconnected " << devnode << std::endl; }
+
+}
+
+void osa3Dconnexion::Internals::Hotplug(){
+
+#if (SAW_HAS_UDEV)
+    osa3DconnexionHotplug::Event event;
+    while( monitor.ReadEvent( event ) ){
+
+        if( event.type == osa3DconnexionHotplug::Event::REMOVED &&
+            DataFD() != -1 &&
+            ( event.devnode == inputfn || event.devnode == eventfn ) )
+            { Disconnect(); }
+
+        // reopen the same kind of node
+        if( event.type == osa3DconnexionHotplug::Event::ADDED && DataFD() == -1 ){
+            std::string name = event.devnode.substr( event.devnode.rfind( '/' ) + 1 );
+            if( ( backend == osa3Dconnexion::JOYSTICK && name.compare( 0, 2, "js" ) == 0 ) ||
+                ( backend == osa3Dconnexion::EVDEV && name.compare( 0, 5, "event" ) == 0 ) )
+                { Reopen( event.devnode ); }
+        }
+
+    }
+#endif
+
+}
+
+size_t osa3Dconnexion::Internals::Drain( osa3Dconnexion::Event* events,
+                                         size_t maxevents ){
+
+    // drain all the queued events with a single system call, a stream can
+    // cut the last event short so keep the partial event for the next read
+    size_t count = 0;
+    ssize_t n;
+    if( backend == osa3Dconnexion::EVDEV ){
+        char* buffer = reinterpret_cast<char*>( evbuffer );
+        n = read( eventfd, buffer+partial, maxevents*sizeof(struct input_event)-partial );
+        if( 0 < n ){
+            size_t nevents = ( partial+n )/sizeof(struct input_event);
+            partial = ( partial+n )%sizeof(struct input_event);
+            if( recorder.IsRecording() )
+                { Record( evbuffer, nevents ); }
+            for( size_t i=0; i<nevents; i++ ){
+                if( Decode( evbuffer[i], events[count] ) )
+                    { count++; }
+                // keep a slot for each raw event left
+                count += Resynced( events+count, maxevents-count-(nevents-1-i) );
+            }
+            memmove( buffer, evbuffer+nevents, partial );
+        }
+    }
+    else{
+        char* buffer = reinterpret_cast<char*>( jsbuffer );
+        n = read( inputfd, buffer+partial, maxevents*sizeof(struct js_event)-partial );
+        if( 0 < n ){
+            size_t nevents = ( partial+n )/sizeof(struct js_event);
+            partial = ( partial+n )%sizeof(struct js_event);
+            if( recorder.IsRecording() )
+                { Record( jsbuffer, nevents ); }
+            Map( jsbuffer, nevents );
+            for( size_t i=0; i<nevents; i++ ){
+                if( Decode( jsbuffer[i], events[count] ) )
+                    { count++; }
+            }
+            memmove( buffer, jsbuffer+nevents, partial );
+
+            // the report is complete once the driver queue is empty
+            if( pending ){
+                drained = ( nevents < maxevents );
+                if( !drained ){
+                    struct pollfd pfd;
+                    pfd.fd = inputfd;
+                    pfd.events = POLLIN;
+                    pfd.revents = 0;
+                    drained = ( poll( &pfd, 1, 0 ) == 0 );
+                }
+                if( drained && count < maxevents )
+                    { Flush( events[count++] ); }
+            }
+        }
+    }
+
+    // the device is gone (ENODEV) or the stream ended
+    if( n == 0 && virtualdevice ){
+        CMN_LOG_RUN_VERBOSE << "End of virtual device stream" << std::endl;
+        Disconnect();
+    }
+    else if( n == 0 || ( n == -1 && errno != EAGAIN ) ){
+        CMN_LOG_RUN_ERROR << "Failed to read device" << std::endl;
+        Disconnect();
+    }
+
+    return count;
+
+}
+
+size_t osa3Dconnexion::Internals::Read( osa3Dconnexion::Event* events,
+                                        size_t maxevents,
+                                        double timeout ){
+
+    // never read more than the internal buffer can hold
+    if( BUFFERSIZE < maxevents )
+        { maxevents = BUFFERSIZE; }
+    if( maxevents == 0 )
+        { return 0; }
+
+    // a complete joystick report is waiting
+    if( pending && drained ){
+        Flush( events[0] );
+        return 1;
+    }
+
+    // resynchronization events which didn't fit in the last read
+    if( resynccount != 0 )
+        { return Resynced( events, maxevents ); }
+
+    if( replay.IsReplaying() )
+        { return Replay( events, maxevents, timeout ); }
+
+    double deadline = osa3DconnexionNow() + timeout;
+
+    for( ;; ){
+
+        double wait = timeout;
+        bool retry = false;
+        if( DataFD() == -1 ){
+            if( !hotplug || filename.empty() ){
+                // report once, the caller keeps polling
+                if( !invalid )
+                    { CMN_LOG_RUN_ERROR << "Invalid device" << std::endl; }
+                invalid = true;
+                return 0;
+            }
+#if !(SAW_HAS_UDEV)
+            // without udev notifications, try to reopen periodically
+            double now = osa3DconnexionNow();
+            if( osa3DconnexionRetryPeriod <= now - lastretry ){
+                lastretry = now;
+                Reopen( filename );
+            }
+            if( DataFD() == -1 && ( wait < 0.0 || osa3DconnexionRetryPeriod < wait ) ){
+                wait = osa3DconnexionRetryPeriod;
+                retry = true;
+            }
+#endif
+        }
+
+        size_t count = 0;
+        switch( Poll( wait ) ){
+        case PERROR:
+            CMN_LOG_RUN_ERROR << "Failed to poll device" << std::endl;
+            return 0;
+        case PINTERRUPT:
+            return 0;
+        case PTIMEOUT:
+            if( !retry )
+                { return 0; }
+            break;
+        case PHOTPLUG:
+            Hotplug();
+            break;
+        case PHANGUP:
+            Disconnect();
+            if( !hotplug )
+                { return 0; }
+            break;
+        case PDATA:
+            count = Drain( events, maxevents );
+            if( 0 < count )
+                { return count; }
+            if( DataFD() == -1 && !hotplug )
+                { return 0; }
+            break;
+        }
+
+        // only synchronization events were read, wait for the remaining time
+        if( 0.0 <= timeout ){
+            timeout = deadline - osa3DconnexionNow();
+            if( timeout <= 0.0 )
+                { return 0; }
+        }
+
+    }
+
+}
+
+size_t osa3Dconnexion::Internals::Replay( osa3Dconnexion::Event* events,
+                                          size_t maxevents,
+                                          double timeout ){
+
+    double deadline = osa3DconnexionNow() + timeout;
+
+    for( ;; ){
+
+        // wait for the next record (until interrupted once finished)
+        double delay = replay.GetDelay();
+        if( delay != 0.0 ){
+            double wait = timeout;
+            if( 0.0 < delay && ( wait < 0.0 || delay < wait ) )
+                { wait = delay; }
+            int result = Poll( wait );
+            if( result == PERROR ){
+                CMN_LOG_RUN_ERROR << "Failed to poll device" << std::endl;
+                return 0;
+            }
+            if( result == PINTERRUPT )
+                { return 0; }
+        }
+
+        // decode the records with the same code path as the device
+        size_t count = 0;
+        size_t n = replay.Read( records, maxevents );
+        for( size_t i=0; i<n; i++ ){
+            const osa3DconnexionLog::Record& r = records[i];
+            if( r.source == osa3DconnexionLog::Record::JOYSTICK ){
+                struct js_event e;
+                e.time = static_cast<unsigned int>( r.utimestamp / 1000 );
+                e.value = static_cast<short>( r.value[0] );
+                e.type = static_cast<unsigned char>( r.type );
+                e.number = static_cast<unsigned char>( r.code );
+                if( Decode( e, events[count] ) )
+                    { count++; }
+            }
+            else if( r.source == osa3DconnexionLog::Record::EVDEV ){
+                struct input_event e;
+                e.time.tv_sec = r.utimestamp / 1000000;
+                e.time.tv_usec = r.utimestamp % 1000000;
+                e.type = r.type;
+                e.code = r.code;
+                e.value = r.value[0];
+                if( Decode( e, events[count] ) )
+                    { count++; }
+                // keep a slot for each record left
+                count += Resynced( events+count, maxevents-count-(n-1-i) );
+            }
+        }
+
+        // the joystick report is complete if the next record is not due
+        if( pending && 0 < n ){
+            drained = ( replay.GetDelay() != 0.0 );
+            if( drained && count < maxevents )
+                { Flush( events[count++] ); }
+        }
+
+        if( 0 < count )
+            { return count; }
+
+        // wait for the remaining time
+        if( 0.0 <= timeout ){
+            timeout = deadline - osa3DconnexionNow();
+            if( timeout <= 0.0 )
+                { return 0; }
+        }
+
+    }
+
+}
+
+void osa3Dconnexion::Internals::Record( const struct js_event* e, size_t count ){
+    for( size_t i=0; i<count; i++ ){
+        memset( &records[i], 0, sizeof( records[i] ) );
+        records[i].utimestamp = e[i].time * 1000LL;
+        records[i].source = osa3DconnexionLog::Record::JOYSTICK;
+        records[i].type = e[i].type;
+        records[i].code = e[i].number;
+        records[i].value[0] = e[i].value;
+    }
+    recorder.Write( records, count );
+}
+
+void osa3Dconnexion::Internals::Record( const struct input_event* e, size_t count ){
+    for( size_t i=0; i<count; i++ ){
+        memset( &records[i], 0, sizeof( records[i] ) );
+        records[i].utimestamp = e[i].time.tv_sec * 1000000LL + e[i].time.tv_usec;
+        records[i].source = osa3DconnexionLog::Record::EVDEV;
+        records[i].type = e[i].type;
+        records[i].code = e[i].code;
+        records[i].value[0] = e[i].value;
+    }
+    recorder.Write( records, count );
+}
+
+void osa3Dconnexion::Internals::Reset( osa3Dconnexion::Backend backend,
+                                       const std::string& filename ){
+    this->backend = backend;
+    this->filename = filename;
+    partial = 0;
+    virtualdevice = false;
+    jsoffset = 0;
+    jsmapped = false;
+    pending = false;
+    drained = false;
+    dropped = false;
+    resynchead = 0;
+    resynccount = 0;
+    invalid = false;
+    queuehead = 0;
+    queuecount = 0;
+    buttons = 0;
+    for( size_t i=0; i<6; i++ ){
+        data[i] = 0;
+        values[i] = 0;
+        reported[i] = 0;
+    }
+}
+
+void osa3Dconnexion::Internals::Map( const struct js_event* e, size_t count ){
+
+    // the clock wraps after 49 days, start over if the delay jumps by days
+    long long now = osa3DconnexionLog::Now();
+    for( size_t i=0; i<count; i++ ){
+        long long offset = now - static_cast<long long>( e[i].time ) * 1000;
+        if( !jsmapped || offset < jsoffset || offset - jsoffset > 86400000000LL ){
+            jsoffset = offset;
+            jsmapped = true;
+        }
+    }
+
+}
+
+void osa3Dconnexion::Internals::Flush( osa3Dconnexion::Event& event ){
+    event.type = osa3Dconnexion::Event::MOTION;
+    event.timestamp = pendingtime;
+    event.utimestamp = static_cast<long long>( pendingtime ) * 1000 + jsoffset;
+    Copy( event );
+    pending = false;
+    drained = false;
+}
+
+void osa3Dconnexion::Internals::Copy( osa3Dconnexion::Event& event ) const {
+    for( size_t i=0; i<6; i++ ){
+        event.data[i] = data[i];
+        event.values[i] = values[i];
+    }
+    event.buttons = buttons;
+}
+
+bool osa3Dconnexion::Internals::Decode( const struct js_event& e,
+                                        osa3Dconnexion::Event& event ){
+
+    event.type = osa3Dconnexion::Event::UNKNOWN;
+
+    // copy the timestamp
+    event.timestamp = e.time;
+    event.utimestamp = static_cast<long long>( e.time ) * 1000 + jsoffset;
+
+    // Initial state of the device
+    if( e.type & JS_EVENT_INIT ){
+        if( ( e.type & ~JS_EVENT_INIT ) == JS_EVENT_AXIS && e.number < 6 )
+            { values[ e.number ] = e.value; }
+        if( ( e.type & ~JS_EVENT_INIT ) == JS_EVENT_BUTTON && e.number < 32 ){
+            if( e.value ) { buttons |= ( 1u << e.number ); }
+            else          { buttons &= ~( 1u << e.number ); }
+        }
+        return false;
+    }
+
+    // Button event
+    if( e.type == JS_EVENT_BUTTON ){
+
+        if( e.number < 32 ){
+            if( e.value ) { buttons |= ( 1u << e.number ); }
+            else          { buttons &= ~( 1u << e.number ); }
+        }
+
+        // Find which button
+        if( e.number == 0 )
+            { event.button = osa3Dconnexion::Event::BUTTON1; }
+        else if( e.number == 1 )
+            { event.button = osa3Dconnexion::Event::BUTTON2; }
+        else
+            { return false; }
+
+        // Find which button event
+        if( e.value == 0 )
+            { event.type = osa3Dconnexion::Event::BUTTON_RELEASED; }
+        if( e.value == 1 )
+            { event.type = osa3Dconnexion::Event::BUTTON_PRESSED; }
+
+    }
+
+    // Axis event
+    if( e.type == JS_EVENT_AXIS && e.number < 6 ){
+
+        // axes of the same report share the timestamp
+        if( coalesce ){
+            bool flushed = false;
+            if( pending && e.time != pendingtime ){
+                Flush( event );
+                flushed = true;
+            }
+            values[ e.number ] = e.value;
+            data[ e.number ] += e.value;
+            pending = true;
+            drained = false;
+            pendingtime = e.time;
+            return flushed;
+        }
+
+        event.type = osa3Dconnexion::Event::MOTION;
+        // accumulate the axis value to the internals
+        values[ e.number ] = e.value;
+        data[ e.number ] += e.value;
+
+    }
+
+    if( event.type == osa3Dconnexion::Event::UNKNOWN )
+        { return false; }
+
+    // copy all the axis to the event
+    Copy( event );
+    return true;
+
+}
+
+bool osa3Dconnexion::Internals::Decode( const struct input_event& e,
+                                        osa3Dconnexion::Event& event ){
+
+    event.type = osa3Dconnexion::Event::UNKNOWN;
+
+    // copy the timestamp
+    event.utimestamp = static_cast<long long>( e.time.tv_sec ) * 1000000 + e.time.tv_usec;
+    event.timestamp = static_cast<unsigned int>( event.utimestamp / 1000 );
+
+    // the kernel buffer overflowed, the events up to the next report are
+    // incomplete so drop them and query the state at the report
+    if( e.type == EV_SYN && e.code == SYN_DROPPED ){
+        for( size_t i=0; i<6; i++ )
+            { data[i] = reported[i]; }
+        dropped = true;
+        pending = false;
+        return false;
+    }
+    if( dropped ){
+        if( e.type == EV_SYN && e.code == SYN_REPORT ){
+            dropped = false;
+            Resynchronize( event.utimestamp );
+        }
+        return false;
+    }
+
+    // Button event (BTN_0 and BTN_1)
+    if( e.type == EV_KEY && BTN_0 <= e.code && e.code < BTN_0 + 32 ){
+
+        unsigned int number = e.code - BTN_0;
+        if( e.value ) { buttons |= ( 1u << number ); }
+        else          { buttons &= ~( 1u << number ); }
+
+        // Find which button
+        if( number == 0 )
+            { event.button = osa3Dconnexion::Event::BUTTON1; }
+        else if( number == 1 )
+            { event.button = osa3Dconnexion::Event::BUTTON2; }
+        else
+            { return false; }
+
+        // Find which button event (ignore auto repeat)
+        if( e.value == 0 )
+            { event.type = osa3Dconnexion::Event::BUTTON_RELEASED; }
+        if( e.value == 1 )
+            { event.type = osa3Dconnexion::Event::BUTTON_PRESSED; }
+
+    }
+
+    // Axis event (depending on the kernel, the device reports relative or
+    // absolute axis but both are the displacement of the cap)
+    if( ( e.type == EV_REL && e.code <= REL_RZ ) ||
+        ( e.type == EV_ABS && e.code <= ABS_RZ ) ){
+
+        values[ e.code ] = e.value;
+        data[ e.code ] += e.value;
+        if( coalesce ){
+            pending = true;
+            return false;
+        }
+        event.type = osa3Dconnexion::Event::MOTION;
+
+    }
+
+    // End of a device report
+    if( e.type == EV_SYN && e.code == SYN_REPORT ){
+        for( size_t i=0; i<6; i++ )
+            { reported[i] = data[i]; }
+        if( coalesce && pending ){
+            event.type = osa3Dconnexion::Event::MOTION;
+            pending = false;
+        }
+    }
+
+    if( event.type == osa3Dconnexion::Event::UNKNOWN )
+        { return false; }
+
+    Copy( event );
+    return true;
+
+}
+
+void osa3Dconnexion::Internals::InitializeState(){
+
+    // use the monotonic clock so timestamps can be compared to the read time
+    int clockid = CLOCK_MONOTONIC;
+    if( ioctl( eventfd, EVIOCSCLOCKID, &clockid ) == -1 )
+        { CMN_LOG_RUN_WARNING << "Failed to set monotonic timestamps" << std::endl; }
+
+    QueryState();
+
+}
+
+unsigned int osa3Dconnexion::Internals::QueryState(){
+
+    // absolute axes (newer kernels)
+    unsigned int queried = 0;
+    for( size_t i=0; i<6; i++ ){
+        struct input_absinfo absinfo;
+        if( ioctl( eventfd, EVIOCGABS( ABS_X + i ), &absinfo ) != -1 ){
+            values[i] = absinfo.value;
+            queried |= ( 1u << i );
+        }
+    }
+
+    // buttons
+    unsigned char keys[ KEY_MAX/8 + 1 ];
+    memset( keys, 0, sizeof( keys ) );
+    if( ioctl( eventfd, EVIOCGKEY( sizeof( keys ) ), keys ) != -1 ){
+        buttons = 0;
+        for( unsigned int i=0; i<32; i++ ){
+            unsigned int code = BTN_0 + i;
+            if( keys[ code/8 ] & ( 1 << ( code%8 ) ) )
+                { buttons |= ( 1u << i ); }
+        }
+    }
+    else { CMN_LOG_RUN_WARNING << "Failed to query the buttons" << std::endl; }
+
+    return queried;
+
+}
+
+void osa3Dconnexion::Internals::Resynchronize( long long utimestamp ){
+
+    unsigned int previous = buttons;
+    unsigned int queried = QueryState();
+
+    // the queried axes replace the reports lost
+    for( size_t i=0; i<6; i++ ){
+        if( queried & ( 1u << i ) )
+            { data[i] += values[i]; }
+        reported[i] = data[i];
+    }
+
+    resynchead = 0;
+    resynccount = 0;
+    unsigned int changed = previous ^ buttons;
+    for( unsigned int i=0; i<2; i++ ){
+        if( changed & ( 1u << i ) ){
+            osa3Dconnexion::Event& event = resync[ resynccount++ ];
+            event.type = ( buttons & ( 1u << i ) ) ?
+                osa3Dconnexion::Event::BUTTON_PRESSED :
+                osa3Dconnexion::Event::BUTTON_RELEASED;
+            event.button = ( i == 0 ) ?
+                osa3Dconnexion::Event::BUTTON1 :
+                osa3Dconnexion::Event::BUTTON2;
+        }
+    }
+    resync[ resynccount++ ].type = osa3Dconnexion::Event::MOTION;
+    for( size_t i=0; i<resynccount; i++ ){
+        resync[i].utimestamp = utimestamp;
+        resync[i].timestamp = static_cast<unsigned int>( utimestamp / 1000 );
+        Copy( resync[i] );
+    }
+
+}
+
+size_t osa3Dconnexion::Internals::Resynced( osa3Dconnexion::Event* events,
+                                            size_t maxevents ){
+    size_t count = 0;
+    while( resynccount != 0 && count < maxevents ){
+        events[count++] = resync[resynchead++];
+        resynccount--;
+    }
+    return count;
+}
+
+#endif
+
 osa3Dconnexion::osa3Dconnexion() :
     internals( NULL ) { 
     
@@ -57,9 +844,31 @@ osa3Dconnexion::osa3Dconnexion() :
     // initialize the structure
 #if (CISST_OS == CISST_LINUX)
 
+    internals->self = this;
+    internals->backend = osa3Dconnexion::JOYSTICK;
+    internals->hotplug = false;
+    internals->invalid = false;
+    internals->lastretry = 0.0;
     internals->inputfd = -1;
     internals->eventfd = -1;
-    for( size_t i=0; i<6; i++ ){ internals->data[i] = 0; }
+    internals->wakeupfd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+    if( internals->wakeupfd == -1 )
+        { CMN_LOG_RUN_ERROR << "Failed to create wakeup channel" << std::endl; }
+    for( size_t i=0; i<6; i++ ){
+        internals->data[i] = 0;
+        internals->values[i] = 0;
+        internals->reported[i] = 0;
+    }
+    internals->buttons = 0;
+    internals->coalesce = false;
+    internals->pending = false;
+    internals->drained = false;
+    internals->dropped = false;
+    internals->resynchead = 0;
+    internals->resynccount = 0;
+    internals->pendingtime = 0;
+    internals->queuehead = 0;
+    internals->queuecount = 0;
 
 #else
 #endif
@@ -73,6 +882,8 @@ osa3Dconnexion::~osa3Dconnexion(){
 #if (CISST_OS == CISST_LINUX)
 
         Close();
+        if( internals->wakeupfd != -1 )
+            { close( internals->wakeupfd ); }
 
 #else
 #endif
@@ -83,58 +894,232 @@ osa3Dconnexion::~osa3Dconnexion(){
 
 }
 
-osa3Dconnexion::Errno osa3Dconnexion::Open( const std::string& filename ){
+#if (CISST_OS == CISST_LINUX)
+
+// Read the first line of a sysfs attribute
+static std::string osa3DconnexionReadAttribute( const std::string& path ){
+    std::ifstream file( path.c_str() );
+    std::string line;
+    std::getline( file, line );
+    return line;
+}
+
+// Count the bits of a sysfs capability bitmask (i.e. "3f 0 1000")
+static size_t osa3DconnexionCountBits( const std::string& bitmask ){
+    std::istringstream words( bitmask );
+    std::string word;
+    size_t count = 0;
+    while( words >> word ){
+        for( unsigned long bits=strtoul( word.c_str(), NULL, 16 ); bits; bits>>=1 )
+            { count += bits & 1; }
+    }
+    return count;
+}
+
+// Return the first entry of a directory starting with the prefix
+static std::string osa3DconnexionFindEntry( const std::string& path,
+                                            const std::string& prefix ){
+    std::string entry;
+    DIR* dir = opendir( path.c_str() );
+    if( dir != NULL ){
+        struct dirent* d;
+        while( entry.empty() && ( d = readdir( dir ) ) != NULL ){
+            if( strncmp( d->d_name, prefix.c_str(), prefix.size() ) == 0 )
+                { entry = d->d_name; }
+        }
+        closedir( dir );
+    }
+    return entry;
+}
+
+// Describe the input device in sysfs (/sys/class/input/input?) with the
+// nodes in devinput (i.e. /dev/input)
+static void osa3DconnexionDescribe( const std::string& sysfs,
+                                    const std::string& devinput,
+                                    osa3Dconnexion::Descriptor& descriptor ){
+
+    descriptor.jsnode.clear();
+    descriptor.eventnode.clear();
+    std::string js = osa3DconnexionFindEntry( sysfs, "js" );
+    if( !js.empty() )
+        { descriptor.jsnode = devinput + "/" + js; }
+    std::string event = osa3DconnexionFindEntry( sysfs, "event" );
+    if( !event.empty() )
+        { descriptor.eventnode = devinput + "/" + event; }
+
+    descriptor.name = osa3DconnexionReadAttribute( sysfs + "/name" );
+    std::string vendor = osa3DconnexionReadAttribute( sysfs + "/id/vendor" );
+    std::string product = osa3DconnexionReadAttribute( sysfs + "/id/product" );
+    descriptor.vendor = static_cast<unsigned short>( strtoul( vendor.c_str(), NULL, 16 ) );
+    descriptor.product = static_cast<unsigned short>( strtoul( product.c_str(), NULL, 16 ) );
+
+    // older kernels report relative axes
+    descriptor.naxes =
+        osa3DconnexionCountBits( osa3DconnexionReadAttribute( sysfs + "/capabilities/abs" ) );
+    if( descriptor.naxes == 0 ){
+        descriptor.naxes =
+            osa3DconnexionCountBits( osa3DconnexionReadAttribute( sysfs + "/capabilities/rel" ) );
+    }
+    descriptor.nbuttons =
+        osa3DconnexionCountBits( osa3DconnexionReadAttribute( sysfs + "/capabilities/key" ) );
+
+}
+
+#else
+#endif
+
+osa3Dconnexion::Errno osa3Dconnexion::Open( const std::string& filename,
+                                            osa3Dconnexion::Backend backend ){
+
+#if (CISST_OS == CISST_LINUX)
+
+    // replay a log instead of a device
+    if( backend == osa3Dconnexion::REPLAY ){
+        if( internals == NULL || internals->DataFD() != -1 ||
+            internals->replay.Load( filename ) != osa3DconnexionLog::ESUCCESS )
+            { return osa3Dconnexion::EFAILURE; }
+        internals->Reset( backend, filename );
+        return osa3Dconnexion::ESUCCESS;
+    }
+
+    if( !filename.empty() ){
+
+        // Get the /dev/input/js? dirname and basename
+        std::string devinput( "." );
+        std::string node( filename );
+        size_t slash = filename.rfind( '/' );
+        if( slash != std::string::npos ){
+            devinput = filename.substr( 0, slash );
+            node = filename.substr( slash+1 );
+        }
+
+        // the device directory of the node lists the other node
+        osa3Dconnexion::Descriptor descriptor;
+        osa3DconnexionDescribe( "/sys/class/input/" + node + "/device",
+                                devinput,
+                                descriptor );
+
+        // keep the name given by the caller
+        if( node.compare( 0, 5, "event" ) == 0 ){
+            if( backend == osa3Dconnexion::JOYSTICK ){
+                CMN_LOG_RUN_ERROR << filename << " is not a joystick device"
+                                  << std::endl;
+                return osa3Dconnexion::EFAILURE;
+            }
+            descriptor.jsnode.clear();
+            descriptor.eventnode = filename;
+        }
+        else
+            { descriptor.jsnode = filename; }
+
+        return Open( descriptor, backend );
+
+    }
+
+#else
+#endif
+
+    return osa3Dconnexion::ESUCCESS;
+}
+
+osa3Dconnexion::Errno osa3Dconnexion::Open( const osa3Dconnexion::Descriptor& descriptor,
+                                            osa3Dconnexion::Backend backend ){
 
     if( internals != NULL ){
 
 #if (CISST_OS == CISST_LINUX)
 
         // only open if device is closed
-        if( internals->inputfd == -1 ){
+        if( internals->inputfd == -1 && internals->eventfd == -1 ){
+
+            if( backend == osa3Dconnexion::REPLAY ){
+                CMN_LOG_RUN_ERROR << "Descriptors cannot be replayed" << std::endl;
+                return osa3Dconnexion::EFAILURE;
+            }
+
+            const std::string& filename = ( backend == osa3Dconnexion::EVDEV ) ?
+                descriptor.eventnode : descriptor.jsnode;
+            if( filename.empty() ){
+                CMN_LOG_RUN_ERROR << "No "
+                                  << ( backend == osa3Dconnexion::EVDEV ? "event" : "joystick" )
+                                  << " device for " << descriptor.name << std::endl;
+                return osa3Dconnexion::EFAILURE;
+            }
 
-            if( !filename.empty() ){
+            internals->Reset( backend, filename );
+            internals->inputfn = descriptor.jsnode;
+            internals->eventfn = descriptor.eventnode;
 
-                // try to open the /dev/input/js?
-                internals->inputfn = filename;
-                internals->inputfd = open( filename.c_str(), O_RDONLY );
+            // try to open the /dev/input/js?
+            if( backend == osa3Dconnexion::JOYSTICK ){
+                internals->inputfd = open( internals->inputfn.c_str(), O_RDONLY | O_NONBLOCK );
                 if( internals->inputfd == -1 ){
-                    CMN_LOG_RUN_ERROR << "Failed to open " << filename << std::endl;
+                    CMN_LOG_RUN_ERROR << "Failed to open " << internals->inputfn << std::endl;
                     return osa3Dconnexion::EFAILURE;
                 }
-                
-                // Get the /dev/input/js? dirname and basename
-                char devinputjs[128];
-                strcpy( devinputjs, filename.c_str() );
-                const char* js = basename( devinputjs );
-                const char* devinput = dirname( devinputjs );
-
-                // find the corresponding event file in /sys/class/input
-                char sysfs[128];
-                for( size_t i=0; i<99; i++ ){
-                    memset( sysfs, 0, sizeof( sysfs ) );
-                    sprintf( sysfs, "/sys/class/input/%s/device/event%d", js, i );
-                    DIR* dir = opendir( sysfs );
-                    if( dir != NULL ){
-                        closedir( dir );
-                        break;
-                    }
-                }
+            }
+
+            // try to open /dev/input/event (only critical for evdev)
+            if( !internals->eventfn.empty() )
+                { internals->eventfd = open( internals->eventfn.c_str(), O_RDWR | O_NONBLOCK ); }
+            if( internals->eventfd != -1 ){
+                LEDOn();
+                if( backend == osa3Dconnexion::EVDEV )
+                    { internals->InitializeState(); }
+            }
+            else if( !internals->eventfn.empty() ){
+                CMN_LOG_RUN_ERROR << "Failed to open event device of "
+                                  << filename << std::endl;
+                if( backend == osa3Dconnexion::EVDEV )
+                    { return osa3Dconnexion::EFAILURE; }
+            }
+            // i.e. a FIFO used as a virtual joystick
+            else
+                { CMN_LOG_RUN_VERBOSE << "No event device for " << filename << std::endl; }
+
+        }
+
+#else
+#endif
+
+    }
+
+    return osa3Dconnexion::ESUCCESS;
+}
+
+osa3Dconnexion::Errno osa3Dconnexion::Open( int fd,
+                                            osa3Dconnexion::Backend backend ){
+
+    if( internals != NULL ){
+
+#if (CISST_OS == CISST_LINUX)
 
-                // set the corresponding file /dev/input/event
-                const char* event = basename( sysfs );
-                char devinputevent[128];
-                sprintf( devinputevent, "%s/%s", devinput, event );
-
-                // try to open /dev/input/event (not critical)
-                internals->eventfn = std::string( devinputevent );
-                internals->eventfd = open( devinputevent, O_RDWR);
-                if( internals->inputfd != -1 )
-                    { LEDOn(); }
-                else
-                    { CMN_LOG_RUN_ERROR << "Failed to open " << devinputevent << std::endl; }
-                
+        // only open if device is closed
+        if( internals->inputfd == -1 && internals->eventfd == -1 ){
+
+            if( backend == osa3Dconnexion::REPLAY ){
+                CMN_LOG_RUN_ERROR << "File descriptors cannot be replayed" << std::endl;
+                return osa3Dconnexion::EFAILURE;
             }
 
+            // keep our own copy, closed by Close
+            int copy = fcntl( fd, F_DUPFD_CLOEXEC, 0 );
+            if( copy == -1 ){
+                CMN_LOG_RUN_ERROR << "Invalid file descriptor " << fd << std::endl;
+                return osa3Dconnexion::EFAILURE;
+            }
+            fcntl( copy, F_SETFL, fcntl( copy, F_GETFL ) | O_NONBLOCK );
+
+            // no sysfs, LED or initial state and nothing to reopen
+            internals->Reset( backend, "" );
+            internals->virtualdevice = true;
+            internals->inputfn.clear();
+            internals->eventfn.clear();
+            if( backend == osa3Dconnexion::EVDEV )
+                { internals->eventfd = copy; }
+            else
+                { internals->inputfd = copy; }
+
         }
 
 #else
@@ -143,6 +1128,7 @@ osa3Dconnexion::Errno osa3Dconnexion::Open( const std::string& filename ){
     }
 
     return osa3Dconnexion::ESUCCESS;
+
 }
 
 osa3Dconnexion::Errno osa3Dconnexion::Close(){
@@ -150,18 +1136,25 @@ osa3Dconnexion::Errno osa3Dconnexion::Close(){
     if( internals != NULL ){
         
 #if (CISST_OS == CISST_LINUX)
+
+        // don't reopen the device once closed
+        internals->filename.clear();
+        internals->replay.Close();
         
         // close the device if not already closed
         if( internals->inputfd != -1 ){
             if( close( internals->inputfd ) == -1 )
                 { CMN_LOG_RUN_ERROR << "Failed to close input." << std::endl; }
+            internals->inputfd = -1;
         }
     
         // close the device if not already closed
         if( internals->eventfd != -1 ){
-            LEDOff();
+            if( !internals->virtualdevice )
+                { LEDOff(); }
             if( close( internals->eventfd ) == -1 )
                 { CMN_LOG_RUN_ERROR << "Failed to close event." << std::endl; }
+            internals->eventfd = -1;
         }
         
 #else
@@ -244,7 +1237,7 @@ osa3Dconnexion::Errno osa3Dconnexion::LEDOff(){
 
 }
 
-osa3Dconnexion::Event osa3Dconnexion::WaitForEvent(){
+osa3Dconnexion::Event osa3Dconnexion::WaitForEvent( double timeout ){
 
     osa3Dconnexion::Event event;
     event.type = osa3Dconnexion::Event::UNKNOWN;
@@ -253,49 +1246,18 @@ osa3Dconnexion::Event osa3Dconnexion::WaitForEvent(){
 
 #if (CISST_OS == CISST_LINUX)
         
-        // check the file descriptor
-        if( internals->inputfd != -1 ){
-            
-            // read the event
-            struct js_event e; 
-            if( read( internals->inputfd, &e, sizeof(struct js_event) ) != -1 ){
-                
-                // copty the timestamp
-                event.timestamp = e.time;
-                
-                // Button event
-                if( e.type == JS_EVENT_BUTTON ){
-                    
-                    // Find which button event
-                    if( e.value == 0 )
-                        { event.type = osa3Dconnexion::Event::BUTTON_RELEASED; }
-                    if( e.value == 1 )
-                        { event.type = osa3Dconnexion::Event::BUTTON_PRESSED; }
-                    
-                    // Find which button
-                    if( e.number == 0 )
-                        { event.button = osa3Dconnexion::Event::BUTTON1; }
-                    if( e.number == 1 )
-                        { event.button = osa3Dconnexion::Event::BUTTON2; }
-                    
-                }
-                
-                // Axis event
-                if( e.type == JS_EVENT_AXIS ){
-                    
-                    event.type = osa3Dconnexion::Event::MOTION;
-                    // accumulate the axis value to the internals
-                    internals->data[ e.number ] += e.value; 
-                    // copy all the axis to the event
-                    for( size_t i=0; i<6; i++ )
-                        { event.data[i] = internals->data[ i ]; }
+        // refill the queue with all the events available
+        if( internals->queuecount == 0 ){
+            internals->queuehead = 0;
+            internals->queuecount = internals->Read( internals->queue,
+                                                     Internals::BUFFERSIZE,
+                                                     timeout );
+        }
 
-                }
-                
-            }
-            else { CMN_LOG_RUN_ERROR << "Failed to read device" << std::endl; }
+        if( 0 < internals->queuecount ){
+            event = internals->queue[ internals->queuehead++ ];
+            internals->queuecount--;
         }
-        else { CMN_LOG_RUN_ERROR << "Invalid device" << std::endl; }
 #else
 #endif
 
@@ -304,3 +1266,215 @@ osa3Dconnexion::Event osa3Dconnexion::WaitForEvent(){
     return event;
 }
 
+size_t osa3Dconnexion::ReadEvents( osa3Dconnexion::Event* events,
+                                   size_t maxevents,
+                                   double timeout ){
+
+    size_t count = 0;
+
+    if( internals != NULL && events != NULL ){
+
+#if (CISST_OS == CISST_LINUX)
+
+        // events left by WaitForEvent come first
+        if( 0 < internals->queuecount ){
+            while( count < maxevents && 0 < internals->queuecount ){
+                events[count++] = internals->queue[ internals->queuehead++ ];
+                internals->queuecount--;
+            }
+        }
+        else
+            { count = internals->Read( events, maxevents, timeout ); }
+
+#else
+#endif
+
+    }
+
+    return count;
+}
+
+std::vector<osa3Dconnexion::Descriptor> osa3Dconnexion::Enumerate( bool all ){
+
+    std::vector<osa3Dconnexion::Descriptor> descriptors;
+
+#if (CISST_OS == CISST_LINUX)
+
+    // each /sys/class/input/input? lists its js? and event? nodes
+    DIR* dir = opendir( "/sys/class/input" );
+    if( dir == NULL ){
+        CMN_LOG_RUN_ERROR << "Failed to open /sys/class/input" << std::endl;
+        return descriptors;
+    }
+
+    struct dirent* d;
+    while( ( d = readdir( dir ) ) != NULL ){
+        if( strncmp( d->d_name, "input", 5 ) == 0 ){
+            osa3Dconnexion::Descriptor descriptor;
+            osa3DconnexionDescribe( std::string( "/sys/class/input/" ) + d->d_name,
+                                    "/dev/input",
+                                    descriptor );
+            if( ( !descriptor.jsnode.empty() || !descriptor.eventnode.empty() ) &&
+                ( all || IsSupported( descriptor.vendor, descriptor.product ) ) )
+                { descriptors.push_back( descriptor ); }
+        }
+    }
+    closedir( dir );
+
+#else
+#endif
+
+    return descriptors;
+
+}
+
+bool osa3Dconnexion::IsSupported( unsigned short vendor, unsigned short product ){
+
+    // 3Dconnexion
+    if( vendor == 0x256f )
+        { return true; }
+    // Logitech/3Dconnexion (SpaceTraveler, SpacePilot, SpaceNavigator, ...)
+    if( vendor == 0x046d && 0xc603 <= product && product <= 0xc62f )
+        { return true; }
+    return false;
+
+}
+
+osa3Dconnexion::Errno osa3Dconnexion::SetHotplug( bool enable ){
+
+    if( internals != NULL ){
+
+#if (CISST_OS == CISST_LINUX)
+
+        internals->hotplug = enable;
+#if (SAW_HAS_UDEV)
+        if( enable ){
+            if( internals->monitor.Open() != osa3DconnexionHotplug::ESUCCESS ){
+                CMN_LOG_RUN_ERROR << "Failed to monitor devices" << std::endl;
+                internals->hotplug = false;
+                return osa3Dconnexion::EFAILURE;
+            }
+        }
+        else
+            { internals->monitor.Close(); }
+#endif
+
+#else
+#endif
+
+    }
+
+    return osa3Dconnexion::ESUCCESS;
+
+}
+
+int osa3Dconnexion::GetFileDescriptor() const {
+
+#if (CISST_OS == CISST_LINUX)
+    if( internals != NULL )
+        { return internals->DataFD(); }
+#else
+#endif
+
+    return -1;
+
+}
+
+bool osa3Dconnexion::IsConnected() const {
+
+#if (CISST_OS == CISST_LINUX)
+    if( internals != NULL )
+        { return internals->DataFD() != -1 || internals->replay.IsReplaying(); }
+#else
+#endif
+
+    return false;
+
+}
+
+osa3Dconnexion::Errno osa3Dconnexion::SetRecording( const std::string& filename ){
+
+    if( internals != NULL ){
+
+#if (CISST_OS == CISST_LINUX)
+        if( filename.empty() )
+            { internals->recorder.Close(); }
+        else if( internals->recorder.Create( filename ) != osa3DconnexionLog::ESUCCESS )
+            { return osa3Dconnexion::EFAILURE; }
+#else
+#endif
+
+    }
+
+    return osa3Dconnexion::ESUCCESS;
+
+}
+
+void osa3Dconnexion::SetReplayRate( double rate ){
+
+#if (CISST_OS == CISST_LINUX)
+    if( internals != NULL )
+        { internals->replay.SetRate( rate ); }
+#else
+#endif
+
+}
+
+osa3Dconnexion::Errno osa3Dconnexion::SeekReplay( double time ){
+
+#if (CISST_OS == CISST_LINUX)
+    if( internals != NULL && internals->replay.SeekTime( time ) == osa3DconnexionLog::ESUCCESS ){
+        internals->queuecount = 0;
+        internals->pending = false;
+        return osa3Dconnexion::ESUCCESS;
+    }
+#else
+#endif
+
+    return osa3Dconnexion::EFAILURE;
+
+}
+
+void osa3Dconnexion::SetCoalescing( bool coalesce ){
+
+    if( internals != NULL ){
+
+#if (CISST_OS == CISST_LINUX)
+
+        internals->coalesce = coalesce;
+
+#else
+#endif
+
+    }
+
+}
+
+osa3Dconnexion::Errno osa3Dconnexion::Interrupt(){
+
+    if( internals != NULL ){
+
+#if (CISST_OS == CISST_LINUX)
+
+        if( internals->wakeupfd != -1 ){
+            // eventfd writes are atomic so this is safe from any thread
+            uint64_t one = 1;
+            if( write( internals->wakeupfd, &one, sizeof(one) ) == -1 &&
+                errno != EAGAIN ){
+                CMN_LOG_RUN_ERROR << "Failed to interrupt reader" << std::endl;
+                return osa3Dconnexion::EFAILURE;
+            }
+        }
+        else{
+            CMN_LOG_RUN_ERROR << "Wakeup channel not created" << std::endl;
+            return osa3Dconnexion::EFAILURE;
+        }
+
+#else
+#endif
+
+    }
+
+    return osa3Dconnexion::ESUCCESS;
+
+}
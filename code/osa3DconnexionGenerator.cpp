@@ -0,0 +1,262 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionGenerator.h>
+
+#include <cisstCommon/cmnLogger.h>
+#include <cisstOSAbstraction/osaSleep.h>
+
+#include <sstream>
+
+#include <stdlib.h>           // for strtod
+#include <string.h>           // for memset
+#include <errno.h>            // for errno
+#include <math.h>             // for sin
+#include <time.h>             // for clock_gettime
+#include <unistd.h>           // for close
+#include <sys/socket.h>       // for socketpair/send
+#include <linux/joystick.h>   // for joystick event
+#include <linux/input.h>      // for evdev event
+
+// number of reports written at once
+enum { OSA3DCONNEXIONGENERATOR_BATCH = 64 };
+
+// monotonic time in seconds (same clock as the evdev timestamps)
+static double osa3DconnexionGeneratorNow(){
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+osa3DconnexionGenerator::Errno
+osa3DconnexionGenerator::Parse( const std::string& description,
+                                osa3DconnexionGenerator::Profile& profile ){
+
+    std::istringstream fields( description );
+    std::string type;
+    std::getline( fields, type, ':' );
+
+    if( type == "sinusoid" )     { profile.type = Profile::SINUSOID; }
+    else if( type == "step" )    { profile.type = Profile::STEP; }
+    else if( type == "buttons" ) { profile.type = Profile::BUTTONS; }
+    else{
+        CMN_LOG_RUN_ERROR << "Unknown profile " << description << std::endl;
+        return osa3DconnexionGenerator::EFAILURE;
+    }
+
+    // optional rate, amplitude and frequency
+    double* values[3] = { &profile.rate, &profile.amplitude, &profile.frequency };
+    std::string field;
+    for( size_t i=0; i<3 && std::getline( fields, field, ':' ); i++ ){
+        char* end;
+        *values[i] = strtod( field.c_str(), &end );
+        if( field.empty() || *end != '\0' ){
+            CMN_LOG_RUN_ERROR << "Invalid profile " << description << std::endl;
+            return osa3DconnexionGenerator::EFAILURE;
+        }
+    }
+
+    return osa3DconnexionGenerator::ESUCCESS;
+
+}
+
+osa3DconnexionGenerator::osa3DconnexionGenerator() :
+    backend( osa3Dconnexion::JOYSTICK ),
+    fd( -1 ),
+    stop( false ),
+    running( false ),
+    generated( 0 ){}
+
+osa3DconnexionGenerator::~osa3DconnexionGenerator()
+{ Stop(); }
+
+osa3DconnexionGenerator::Errno
+osa3DconnexionGenerator::Start( osa3Dconnexion& device,
+                                const osa3DconnexionGenerator::Profile& profile,
+                                osa3Dconnexion::Backend backend ){
+
+    if( fd != -1 || device.GetFileDescriptor() != -1 ){
+        CMN_LOG_RUN_ERROR << "Generator or device already started" << std::endl;
+        return osa3DconnexionGenerator::EFAILURE;
+    }
+    if( backend != osa3Dconnexion::JOYSTICK && backend != osa3Dconnexion::EVDEV ){
+        CMN_LOG_RUN_ERROR << "Only joystick and evdev events can be generated" << std::endl;
+        return osa3DconnexionGenerator::EFAILURE;
+    }
+
+    int fds[2];
+    if( socketpair( AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to create socket pair" << std::endl;
+        return osa3DconnexionGenerator::EFAILURE;
+    }
+
+    // the device keeps its own copy of its end
+    device.Open( fds[1], backend );
+    close( fds[1] );
+    if( device.GetFileDescriptor() == -1 ){
+        close( fds[0] );
+        return osa3DconnexionGenerator::EFAILURE;
+    }
+
+    fd = fds[0];
+    this->profile = profile;
+    this->backend = backend;
+    stop = false;
+    running = true;
+    generated = 0;
+    thread.Create<osa3DconnexionGenerator, void*>( this,
+                                                   &osa3DconnexionGenerator::Run,
+                                                   NULL,
+                                                   "3DxGenerator" );
+    return osa3DconnexionGenerator::ESUCCESS;
+
+}
+
+osa3DconnexionGenerator::Errno osa3DconnexionGenerator::Stop(){
+
+    if( fd != -1 ){
+        // unblock a pending write
+        stop = true;
+        shutdown( fd, SHUT_RDWR );
+        thread.Join();
+        close( fd );
+        fd = -1;
+    }
+    return osa3DconnexionGenerator::ESUCCESS;
+
+}
+
+size_t osa3DconnexionGenerator::Report( unsigned long long k,
+                                        double start,
+                                        char* buffer ) const {
+
+    // time of the report
+    double t = ( 0.0 < profile.rate ) ? k / profile.rate : osa3DconnexionGeneratorNow() - start;
+    double time = start + t;
+
+    // raw events of the report
+    size_t n = 0;
+    int types[7], codes[7], values[7];
+    if( profile.type == Profile::BUTTONS ){
+        types[n] = JS_EVENT_BUTTON;
+        codes[n] = ( k / 2 ) % 2;
+        values[n++] = ( k % 2 ) == 0;
+    }
+    else{
+        for( size_t i=0; i<6; i++ ){
+            double value;
+            if( profile.type == Profile::SINUSOID )
+                { value = profile.amplitude * sin( 2.0*M_PI*profile.frequency*t + i*M_PI/3.0 ); }
+            else
+                { value = ( static_cast<long long>( 2.0*profile.frequency*t ) % 2 ) ? profile.amplitude : 0.0; }
+            types[n] = JS_EVENT_AXIS;
+            codes[n] = i;
+            values[n++] = static_cast<int>( value );
+        }
+    }
+
+    if( backend == osa3Dconnexion::JOYSTICK ){
+        struct js_event* events = reinterpret_cast<struct js_event*>( buffer );
+        for( size_t i=0; i<n; i++ ){
+            events[i].time = static_cast<unsigned int>( time * 1000.0 );
+            events[i].type = types[i];
+            events[i].number = codes[i];
+            events[i].value = values[i];
+        }
+        return n * sizeof( struct js_event );
+    }
+
+    // evdev reports end with SYN_REPORT
+    struct input_event* events = reinterpret_cast<struct input_event*>( buffer );
+    for( size_t i=0; i<=n; i++ ){
+        memset( &events[i], 0, sizeof( events[i] ) );
+        events[i].time.tv_sec = static_cast<long>( time );
+        events[i].time.tv_usec = static_cast<long>( ( time - events[i].time.tv_sec ) * 1e6 );
+        if( i == n ){
+            events[i].type = EV_SYN;
+            events[i].code = SYN_REPORT;
+        }
+        else if( types[i] == JS_EVENT_BUTTON ){
+            events[i].type = EV_KEY;
+            events[i].code = BTN_0 + codes[i];
+            events[i].value = values[i];
+        }
+        else{
+            events[i].type = EV_ABS;
+            events[i].code = ABS_X + codes[i];
+            events[i].value = values[i];
+        }
+    }
+    return ( n + 1 ) * sizeof( struct input_event );
+
+}
+
+void* osa3DconnexionGenerator::Run( void* ){
+
+    char buffer[ OSA3DCONNEXIONGENERATOR_BATCH * 7 * sizeof( struct input_event ) ];
+    double start = osa3DconnexionGeneratorNow();
+    unsigned long long k = 0;
+
+    while( !stop ){
+
+        // reports due by now
+        unsigned long long due = k + OSA3DCONNEXIONGENERATOR_BATCH;
+        if( 0.0 < profile.rate ){
+            due = static_cast<unsigned long long>
+                ( ( osa3DconnexionGeneratorNow() - start ) * profile.rate ) + 1;
+        }
+        if( profile.count != 0 && profile.count < due )
+            { due = profile.count; }
+
+        // write them in batches, blocks while the reader is behind
+        while( !stop && k < due ){
+            size_t size = 0;
+            for( size_t i=0; i<OSA3DCONNEXIONGENERATOR_BATCH && k<due; i++, k++ )
+                { size += Report( k, start, buffer+size ); }
+            for( size_t written=0; written<size; ){
+                ssize_t n = send( fd, buffer+written, size-written, MSG_NOSIGNAL );
+                if( n == -1 && errno == EINTR )
+                    { continue; }
+                if( n == -1 ){
+                    stop = true;
+                    break;
+                }
+                written += n;
+            }
+            generated = k;
+        }
+
+        if( profile.count != 0 && profile.count <= k )
+            { break; }
+
+        // sleep until the next report, at most 1 ms to keep batches small
+        if( 0.0 < profile.rate ){
+            double delay = start + k / profile.rate - osa3DconnexionGeneratorNow();
+            if( 0.0 < delay )
+                { osaSleep( delay < 1e-3 ? delay : 1e-3 ); }
+        }
+
+    }
+
+    // the device reads the end of the stream
+    shutdown( fd, SHUT_WR );
+    running = false;
+    return NULL;
+
+}
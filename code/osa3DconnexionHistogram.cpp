@@ -0,0 +1,99 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionHistogram.h>
+
+osa3DconnexionHistogram::osa3DconnexionHistogram()
+{ Reset(); }
+
+size_t osa3DconnexionHistogram::Bucket( long long usec ){
+
+    // durations below 8 microseconds have their own bucket
+    if( usec < SUBBUCKETS )
+        { return ( usec < 0 ) ? 0 : static_cast<size_t>( usec ); }
+
+    // power of two and the 3 bits below the leading bit
+    size_t octave = 63 - __builtin_clzll( static_cast<unsigned long long>( usec ) );
+    size_t sub = static_cast<size_t>( usec >> ( octave-3 ) ) & ( SUBBUCKETS-1 );
+    size_t bucket = ( octave-2 )*SUBBUCKETS + sub;
+    return ( bucket < BUCKETS ) ? bucket : BUCKETS-1;
+
+}
+
+long long osa3DconnexionHistogram::UpperBound( size_t bucket ){
+
+    if( bucket < SUBBUCKETS )
+        { return static_cast<long long>( bucket ); }
+
+    size_t octave = bucket/SUBBUCKETS + 2;
+    long long width = 1LL << ( octave-3 );
+    return static_cast<long long>( SUBBUCKETS + bucket%SUBBUCKETS )*width + width-1;
+
+}
+
+void osa3DconnexionHistogram::Add( long long usec ){
+
+    if( usec < 0 )
+        { usec = 0; }
+    __sync_fetch_and_add( &buckets[ Bucket( usec ) ], 1ULL );
+    __sync_fetch_and_add( &count, 1ULL );
+
+    // another thread can raise the maximum between the test and the swap
+    long long current = max;
+    while( current < usec ){
+        if( __sync_bool_compare_and_swap( &max, current, usec ) )
+            { break; }
+        current = max;
+    }
+
+}
+
+void osa3DconnexionHistogram::Reset(){
+    for( size_t i=0; i<BUCKETS; i++ )
+        { buckets[i] = 0; }
+    count = 0;
+    max = 0;
+}
+
+long long osa3DconnexionHistogram::GetPercentile( double fraction ) const {
+
+    // use the sum of the buckets, count can be ahead of the buckets
+    unsigned long long total = 0;
+    for( size_t i=0; i<BUCKETS; i++ )
+        { total += buckets[i]; }
+    if( total == 0 )
+        { return 0; }
+
+    unsigned long long target = static_cast<unsigned long long>( fraction*total + 0.5 );
+    if( target == 0 )
+        { target = 1; }
+    if( total < target )
+        { target = total; }
+
+    unsigned long long cumulative = 0;
+    for( size_t i=0; i<BUCKETS; i++ ){
+        cumulative += buckets[i];
+        if( target <= cumulative ){
+            long long bound = UpperBound( i );
+            return ( bound < max ) ? bound : max;
+        }
+    }
+    return max;
+
+}
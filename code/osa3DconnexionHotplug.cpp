@@ -0,0 +1,210 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionHotplug.h>
+#include <saw3Dconnexion/osa3Dconnexion.h>
+
+#include <cisstCommon/cmnLogger.h>
+
+#include <stdlib.h>           // for strtoul
+#include <string.h>           // for strncmp
+#include <libudev.h>
+
+struct osa3DconnexionHotplug::Internals{
+    struct udev* udev;
+    struct udev_monitor* monitor;
+};
+
+// Fill an event from an input device node. Return false if the device is
+// not a 3Dconnexion device node. A removed node which can't be identified
+// anymore is returned with vendor and product 0.
+static bool osa3DconnexionHotplugDevice( struct udev_device* device,
+                                         osa3DconnexionHotplug::Event& event,
+                                         bool removed = false ){
+
+    // only keep the nodes i.e. /dev/input/js0 and /dev/input/event3
+    const char* devnode = udev_device_get_devnode( device );
+    const char* sysname = udev_device_get_sysname( device );
+    if( devnode == NULL || sysname == NULL )
+        { return false; }
+    if( strncmp( sysname, "js", 2 ) != 0 && strncmp( sysname, "event", 5 ) != 0 )
+        { return false; }
+
+    // the udev properties are also in remove events, when the sysfs
+    // attributes of the USB parent are already gone
+    const char* vendor = udev_device_get_property_value( device, "ID_VENDOR_ID" );
+    const char* product = udev_device_get_property_value( device, "ID_MODEL_ID" );
+    if( vendor == NULL || product == NULL ){
+        struct udev_device* usb =
+            udev_device_get_parent_with_subsystem_devtype( device, "usb", "usb_device" );
+        if( usb != NULL ){
+            vendor = udev_device_get_sysattr_value( usb, "idVendor" );
+            product = udev_device_get_sysattr_value( usb, "idProduct" );
+        }
+    }
+    if( vendor == NULL || product == NULL ){
+        event.devnode = devnode;
+        event.vendor = 0;
+        event.product = 0;
+        return removed;
+    }
+
+    event.devnode = devnode;
+    event.vendor = static_cast<unsigned short>( strtoul( vendor, NULL, 16 ) );
+    event.product = static_cast<unsigned short>( strtoul( product, NULL, 16 ) );
+    return osa3Dconnexion::IsSupported( event.vendor, event.product );
+
+}
+
+osa3DconnexionHotplug::osa3DconnexionHotplug() :
+    internals( NULL ){
+
+    try{ internals = new osa3DconnexionHotplug::Internals; }
+    catch( std::bad_alloc& )
+        { CMN_LOG_RUN_ERROR << "Failed to allocate internals" << std::endl; }
+
+    if( internals != NULL ){
+        internals->udev = NULL;
+        internals->monitor = NULL;
+    }
+
+}
+
+osa3DconnexionHotplug::~osa3DconnexionHotplug(){
+
+    if( internals != NULL ){
+        Close();
+        delete internals;
+    }
+
+}
+
+osa3DconnexionHotplug::Errno osa3DconnexionHotplug::Open(){
+
+    if( internals == NULL )
+        { return osa3DconnexionHotplug::EFAILURE; }
+
+    // only open if closed
+    if( internals->monitor != NULL )
+        { return osa3DconnexionHotplug::ESUCCESS; }
+
+    internals->udev = udev_new();
+    if( internals->udev == NULL ){
+        CMN_LOG_RUN_ERROR << "Failed to create udev context" << std::endl;
+        return osa3DconnexionHotplug::EFAILURE;
+    }
+
+    // events are received once udev has created the nodes
+    internals->monitor = udev_monitor_new_from_netlink( internals->udev, "udev" );
+    if( internals->monitor == NULL ||
+        udev_monitor_filter_add_match_subsystem_devtype( internals->monitor, "input", NULL ) < 0 ||
+        udev_monitor_enable_receiving( internals->monitor ) < 0 ){
+        CMN_LOG_RUN_ERROR << "Failed to create udev monitor" << std::endl;
+        Close();
+        return osa3DconnexionHotplug::EFAILURE;
+    }
+
+    return osa3DconnexionHotplug::ESUCCESS;
+
+}
+
+osa3DconnexionHotplug::Errno osa3DconnexionHotplug::Close(){
+
+    if( internals != NULL ){
+        if( internals->monitor != NULL ){
+            udev_monitor_unref( internals->monitor );
+            internals->monitor = NULL;
+        }
+        if( internals->udev != NULL ){
+            udev_unref( internals->udev );
+            internals->udev = NULL;
+        }
+    }
+    return osa3DconnexionHotplug::ESUCCESS;
+
+}
+
+int osa3DconnexionHotplug::GetFileDescriptor() const {
+
+    if( internals == NULL || internals->monitor == NULL )
+        { return -1; }
+    return udev_monitor_get_fd( internals->monitor );
+
+}
+
+bool osa3DconnexionHotplug::ReadEvent( osa3DconnexionHotplug::Event& event ){
+
+    if( internals == NULL || internals->monitor == NULL )
+        { return false; }
+
+    // the netlink socket is non blocking, skip the other devices
+    struct udev_device* device;
+    while( ( device = udev_monitor_receive_device( internals->monitor ) ) != NULL ){
+
+        const char* action = udev_device_get_action( device );
+        bool found = false;
+        if( action != NULL && strcmp( action, "add" ) == 0 &&
+            osa3DconnexionHotplugDevice( device, event ) ){
+            event.type = osa3DconnexionHotplug::Event::ADDED;
+            found = true;
+        }
+        if( action != NULL && strcmp( action, "remove" ) == 0 &&
+            osa3DconnexionHotplugDevice( device, event, true ) ){
+            event.type = osa3DconnexionHotplug::Event::REMOVED;
+            found = true;
+        }
+        udev_device_unref( device );
+        if( found )
+            { return true; }
+
+    }
+
+    return false;
+
+}
+
+osa3DconnexionHotplug::Errno osa3DconnexionHotplug::Scan( std::vector<osa3DconnexionHotplug::Event>& devices ){
+
+    devices.clear();
+    if( internals == NULL || internals->udev == NULL )
+        { return osa3DconnexionHotplug::EFAILURE; }
+
+    struct udev_enumerate* enumerate = udev_enumerate_new( internals->udev );
+    if( enumerate == NULL )
+        { return osa3DconnexionHotplug::EFAILURE; }
+    udev_enumerate_add_match_subsystem( enumerate, "input" );
+    udev_enumerate_scan_devices( enumerate );
+
+    struct udev_list_entry* entry;
+    udev_list_entry_foreach( entry, udev_enumerate_get_list_entry( enumerate ) ){
+        struct udev_device* device =
+            udev_device_new_from_syspath( internals->udev, udev_list_entry_get_name( entry ) );
+        if( device != NULL ){
+            osa3DconnexionHotplug::Event event;
+            event.type = osa3DconnexionHotplug::Event::ADDED;
+            if( osa3DconnexionHotplugDevice( device, event ) )
+                { devices.push_back( event ); }
+            udev_device_unref( device );
+        }
+    }
+
+    udev_enumerate_unref( enumerate );
+    return osa3DconnexionHotplug::ESUCCESS;
+
+}
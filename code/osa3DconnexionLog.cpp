@@ -0,0 +1,262 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionLog.h>
+
+#include <cisstCommon/cmnLogger.h>
+
+#include <string.h>           // for memcmp/memcpy
+#include <errno.h>            // for errno
+#include <time.h>             // for clock_gettime
+#include <fcntl.h>            // for open
+#include <unistd.h>           // for write/close
+#include <sys/mman.h>         // for mmap
+#include <sys/stat.h>         // for fstat
+
+// header: magic, version and record size
+static const char osa3DconnexionLogMagic[8] = { 'S','A','W','3','D','L','O','G' };
+enum { OSA3DCONNEXIONLOG_VERSION = 1 };
+
+static void osa3DconnexionLogHeader( char header[osa3DconnexionLog::HEADERSIZE] ){
+    unsigned int version = OSA3DCONNEXIONLOG_VERSION;
+    unsigned int size = sizeof( osa3DconnexionLog::Record );
+    memcpy( header, osa3DconnexionLogMagic, 8 );
+    memcpy( header+8, &version, 4 );
+    memcpy( header+12, &size, 4 );
+}
+
+osa3DconnexionLog::osa3DconnexionLog() :
+    fd( -1 ),
+    writing( false ),
+    records( NULL ),
+    map( NULL ),
+    mapsize( 0 ),
+    count( 0 ),
+    cursor( 0 ),
+    rate( 1.0 ),
+    origin( 0 ),
+    start( 0.0 ){}
+
+osa3DconnexionLog::~osa3DconnexionLog()
+{ Close(); }
+
+osa3DconnexionLog::Errno osa3DconnexionLog::Create( const std::string& filename ){
+
+    Close();
+
+    fd = open( filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644 );
+    if( fd == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to open " << filename << std::endl;
+        return osa3DconnexionLog::EFAILURE;
+    }
+    writing = true;
+
+    // write the header of a new log, append to an existing one
+    struct stat st;
+    if( fstat( fd, &st ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to stat " << filename << std::endl;
+        Close();
+        return osa3DconnexionLog::EFAILURE;
+    }
+    if( st.st_size == 0 ){
+        char header[HEADERSIZE];
+        osa3DconnexionLogHeader( header );
+        if( write( fd, header, HEADERSIZE ) != HEADERSIZE ){
+            CMN_LOG_RUN_ERROR << "Failed to write " << filename << std::endl;
+            Close();
+            return osa3DconnexionLog::EFAILURE;
+        }
+    }
+    else if( st.st_size < HEADERSIZE ||
+             ( st.st_size - HEADERSIZE ) % sizeof( osa3DconnexionLog::Record ) != 0 ){
+        CMN_LOG_RUN_ERROR << filename << " is not a valid log" << std::endl;
+        Close();
+        return osa3DconnexionLog::EFAILURE;
+    }
+
+    return osa3DconnexionLog::ESUCCESS;
+
+}
+
+osa3DconnexionLog::Errno osa3DconnexionLog::Load( const std::string& filename ){
+
+    Close();
+
+    fd = open( filename.c_str(), O_RDONLY | O_CLOEXEC );
+    if( fd == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to open " << filename << std::endl;
+        return osa3DconnexionLog::EFAILURE;
+    }
+
+    struct stat st;
+    char header[HEADERSIZE];
+    osa3DconnexionLogHeader( header );
+    if( fstat( fd, &st ) == -1 || st.st_size < HEADERSIZE ){
+        CMN_LOG_RUN_ERROR << filename << " is not a valid log" << std::endl;
+        Close();
+        return osa3DconnexionLog::EFAILURE;
+    }
+
+    mapsize = st.st_size;
+    map = mmap( NULL, mapsize, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if( map == MAP_FAILED ){
+        CMN_LOG_RUN_ERROR << "Failed to map " << filename << std::endl;
+        map = NULL;
+        Close();
+        return osa3DconnexionLog::EFAILURE;
+    }
+    if( memcmp( map, header, HEADERSIZE ) != 0 ){
+        CMN_LOG_RUN_ERROR << filename << " is not a valid log" << std::endl;
+        Close();
+        return osa3DconnexionLog::EFAILURE;
+    }
+
+    // ignore a record cut short
+    records = reinterpret_cast<const osa3DconnexionLog::Record*>
+        ( static_cast<const char*>( map ) + HEADERSIZE );
+    count = ( mapsize - HEADERSIZE ) / sizeof( osa3DconnexionLog::Record );
+    madvise( map, mapsize, MADV_SEQUENTIAL );
+    return Seek( 0 );
+
+}
+
+osa3DconnexionLog::Errno osa3DconnexionLog::Close(){
+
+    if( map != NULL ){
+        munmap( map, mapsize );
+        map = NULL;
+    }
+    records = NULL;
+    mapsize = 0;
+    count = 0;
+    cursor = 0;
+
+    if( fd != -1 ){
+        if( close( fd ) == -1 )
+            { CMN_LOG_RUN_ERROR << "Failed to close log" << std::endl; }
+        fd = -1;
+    }
+    writing = false;
+
+    return osa3DconnexionLog::ESUCCESS;
+
+}
+
+osa3DconnexionLog::Errno osa3DconnexionLog::Write( const osa3DconnexionLog::Record* records,
+                                                   size_t count ){
+
+    if( !IsRecording() )
+        { return osa3DconnexionLog::EFAILURE; }
+
+    const char* buffer = reinterpret_cast<const char*>( records );
+    size_t size = count * sizeof( osa3DconnexionLog::Record );
+    while( 0 < size ){
+        ssize_t n = write( fd, buffer, size );
+        if( n == -1 ){
+            if( errno == EINTR )
+                { continue; }
+            CMN_LOG_RUN_ERROR << "Failed to write log" << std::endl;
+            return osa3DconnexionLog::EFAILURE;
+        }
+        buffer += n;
+        size -= n;
+    }
+
+    return osa3DconnexionLog::ESUCCESS;
+
+}
+
+void osa3DconnexionLog::SetRate( double rate ){
+
+    // restart the clock from the next record
+    this->rate = rate;
+    Seek( cursor );
+
+}
+
+osa3DconnexionLog::Errno osa3DconnexionLog::Seek( size_t index ){
+
+    if( count < index )
+        { return osa3DconnexionLog::EFAILURE; }
+
+    cursor = index;
+    if( cursor < count )
+        { origin = records[cursor].utimestamp; }
+    start = Now() * 1e-6;
+    return osa3DconnexionLog::ESUCCESS;
+
+}
+
+osa3DconnexionLog::Errno osa3DconnexionLog::SeekTime( double time ){
+
+    if( count == 0 )
+        { return osa3DconnexionLog::EFAILURE; }
+
+    // binary search of the first record at or after the time
+    long long utimestamp = records[0].utimestamp + static_cast<long long>( time * 1e6 );
+    size_t first = 0;
+    size_t last = count;
+    while( first < last ){
+        size_t middle = first + ( last - first ) / 2;
+        if( records[middle].utimestamp < utimestamp )
+            { first = middle + 1; }
+        else
+            { last = middle; }
+    }
+    return Seek( first );
+
+}
+
+double osa3DconnexionLog::GetDelay() const {
+
+    if( IsFinished() )
+        { return -1.0; }
+    if( rate <= 0.0 )
+        { return 0.0; }
+
+    // timestamps going back (i.e. device reopened) are due immediately
+    long long elapsed = records[cursor].utimestamp - origin;
+    if( elapsed <= 0 )
+        { return 0.0; }
+    double delay = start + elapsed * 1e-6 / rate - Now() * 1e-6;
+    return ( 0.0 < delay ) ? delay : 0.0;
+
+}
+
+size_t osa3DconnexionLog::Read( osa3DconnexionLog::Record* records,
+                                size_t maxrecords ){
+
+    size_t n = 0;
+    while( n < maxrecords && !IsFinished() && GetDelay() == 0.0 ){
+        // keep the clock running from the new origin
+        if( this->records[cursor].utimestamp < origin ){
+            origin = this->records[cursor].utimestamp;
+            start = Now() * 1e-6;
+        }
+        records[n++] = this->records[cursor++];
+    }
+    return n;
+
+}
+
+long long osa3DconnexionLog::Now(){
+    struct timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+}
@@ -0,0 +1,106 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionShm.h>
+#include <saw3Dconnexion/osa3DconnexionLog.h>
+
+#include <cisstCommon/cmnLogger.h>
+
+#include <string.h>           // for memcpy
+#include <fcntl.h>            // for O_CREAT
+#include <unistd.h>           // for ftruncate/close
+#include <sys/mman.h>         // for shm_open/mmap
+
+osa3DconnexionShm::osa3DconnexionShm() :
+    segment( NULL ),
+    sequence( 0 ){}
+
+osa3DconnexionShm::~osa3DconnexionShm()
+{ Close(); }
+
+osa3DconnexionShm::Errno osa3DconnexionShm::Create( const std::string& name ){
+
+    Close();
+
+    int fd = shm_open( name.c_str(), O_CREAT | O_RDWR, 0644 );
+    if( fd == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to open shared memory " << name << std::endl;
+        return osa3DconnexionShm::EFAILURE;
+    }
+    if( ftruncate( fd, sizeof( saw3DconnexionShmSegment ) ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to size shared memory " << name << std::endl;
+        close( fd );
+        return osa3DconnexionShm::EFAILURE;
+    }
+    void* map = mmap( NULL, sizeof( saw3DconnexionShmSegment ),
+                      PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+    close( fd );
+    if( map == MAP_FAILED ){
+        CMN_LOG_RUN_ERROR << "Failed to map shared memory " << name << std::endl;
+        shm_unlink( name.c_str() );
+        return osa3DconnexionShm::EFAILURE;
+    }
+
+    // readers check the magic, write it once the layout is set
+    segment = static_cast<saw3DconnexionShmSegment*>( map );
+    memset( segment->magic, 0, sizeof( segment->magic ) );
+    __sync_synchronize();
+    segment->version = SAW3DCONNEXIONSHM_VERSION;
+    segment->size = sizeof( saw3DconnexionShmSample );
+    segment->lock = 0;
+    memset( &(segment->sample), 0, sizeof( saw3DconnexionShmSample ) );
+    __sync_synchronize();
+    memcpy( segment->magic, SAW3DCONNEXIONSHM_MAGIC, sizeof( segment->magic ) );
+    this->name = name;
+    sequence = 0;
+
+    return osa3DconnexionShm::ESUCCESS;
+
+}
+
+osa3DconnexionShm::Errno osa3DconnexionShm::Close(){
+
+    if( segment == NULL )
+        { return osa3DconnexionShm::ESUCCESS; }
+
+    munmap( segment, sizeof( saw3DconnexionShmSegment ) );
+    segment = NULL;
+    if( shm_unlink( name.c_str() ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to remove shared memory " << name << std::endl;
+        return osa3DconnexionShm::EFAILURE;
+    }
+    return osa3DconnexionShm::ESUCCESS;
+
+}
+
+void osa3DconnexionShm::Publish( const saw3DconnexionShmSample& sample ){
+
+    if( segment == NULL )
+        { return; }
+
+    // odd lock while the sample is written
+    segment->lock = segment->lock + 1;
+    __sync_synchronize();
+    memcpy( &(segment->sample), &sample, sizeof( saw3DconnexionShmSample ) );
+    segment->sample.sequence = sequence++;
+    segment->sample.utimestamp = osa3DconnexionLog::Now();
+    __sync_synchronize();
+    segment->lock = segment->lock + 1;
+
+}
@@ -0,0 +1,170 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionSpacenav.h>
+
+#include <cisstCommon/cmnLogger.h>
+
+#include <string.h>           // for memcpy/memmove
+#include <errno.h>            // for errno
+#include <math.h>             // for ceil
+#include <fcntl.h>            // for fcntl
+#include <poll.h>             // for poll
+#include <unistd.h>           // for read/close
+#include <sys/socket.h>       // for socket/connect
+#include <sys/un.h>           // for sockaddr_un
+
+// event types sent by spacenavd
+enum { UEV_MOTION, UEV_PRESS, UEV_RELEASE };
+
+osa3DconnexionSpacenav::osa3DconnexionSpacenav() :
+    fd( -1 ),
+    buffered( 0 ){}
+
+osa3DconnexionSpacenav::~osa3DconnexionSpacenav()
+{ Close(); }
+
+osa3DconnexionSpacenav::Errno osa3DconnexionSpacenav::Open( const std::string& socketname ){
+
+    // only open if the connection is closed
+    if( fd != -1 )
+        { return osa3DconnexionSpacenav::ESUCCESS; }
+
+    struct sockaddr_un addr;
+    if( sizeof( addr.sun_path ) <= socketname.size() ){
+        CMN_LOG_RUN_ERROR << "Socket name too long " << socketname << std::endl;
+        return osa3DconnexionSpacenav::EFAILURE;
+    }
+
+    fd = socket( PF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0 );
+    if( fd == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to create socket" << std::endl;
+        return osa3DconnexionSpacenav::EFAILURE;
+    }
+
+    memset( &addr, 0, sizeof( addr ) );
+    addr.sun_family = AF_UNIX;
+    strncpy( addr.sun_path, socketname.c_str(), sizeof( addr.sun_path ) - 1 );
+
+    if( connect( fd, (struct sockaddr*)&addr, sizeof( addr ) ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to connect to " << socketname << std::endl;
+        close( fd );
+        fd = -1;
+        return osa3DconnexionSpacenav::EFAILURE;
+    }
+
+    // reads are batched, never block in read
+    fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) | O_NONBLOCK );
+
+    this->socketname = socketname;
+    buffered = 0;
+    return osa3DconnexionSpacenav::ESUCCESS;
+
+}
+
+osa3DconnexionSpacenav::Errno osa3DconnexionSpacenav::Close(){
+
+    if( fd != -1 ){
+        if( close( fd ) == -1 )
+            { CMN_LOG_RUN_ERROR << "Failed to close socket" << std::endl; }
+        fd = -1;
+    }
+    buffered = 0;
+    return osa3DconnexionSpacenav::ESUCCESS;
+
+}
+
+size_t osa3DconnexionSpacenav::ReadEvents( osa3DconnexionSpacenav::Event* events,
+                                           size_t maxevents,
+                                           double timeout ){
+
+    if( fd == -1 || events == NULL )
+        { return 0; }
+
+    if( BUFFERSIZE < maxevents )
+        { maxevents = BUFFERSIZE; }
+    if( maxevents == 0 )
+        { return 0; }
+
+    // wait for data
+    int ms = -1;
+    if( 0.0 <= timeout )
+        { ms = static_cast<int>( ceil( timeout * 1000.0 ) ); }
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int result = poll( &pfd, 1, ms );
+    while( result == -1 && errno == EINTR )
+        { result = poll( &pfd, 1, ms ); }
+    if( result <= 0 )
+        { return 0; }
+
+    // complete the partial packet left by the previous read
+    ssize_t n = read( fd, buffer + buffered, maxevents*PACKETSIZE - buffered );
+    if( n == 0 ){
+        CMN_LOG_RUN_ERROR << "Connection closed by " << socketname << std::endl;
+        Close();
+        return 0;
+    }
+    if( n == -1 ){
+        if( errno != EAGAIN ){
+            CMN_LOG_RUN_ERROR << "Failed to read " << socketname << std::endl;
+            Close();
+        }
+        return 0;
+    }
+    buffered += n;
+
+    // decode all the complete packets, unknown packets are skipped
+    size_t count = buffered / PACKETSIZE;
+    size_t decoded = 0;
+    for( size_t i=0; i<count; i++ ){
+        int packet[8];
+        memcpy( packet, buffer + i*PACKETSIZE, PACKETSIZE );
+        osa3DconnexionSpacenav::Event& event = events[decoded];
+        if( packet[0] == UEV_MOTION ){
+            event.type = osa3DconnexionSpacenav::Event::MOTION;
+            for( size_t j=0; j<6; j++ )
+                { event.data[j] = packet[j+1]; }
+            event.period = packet[7];
+            event.button = -1;
+        }
+        else if( packet[0] == UEV_PRESS || packet[0] == UEV_RELEASE ){
+            event.type = ( packet[0] == UEV_PRESS ) ?
+                osa3DconnexionSpacenav::Event::BUTTON_PRESSED :
+                osa3DconnexionSpacenav::Event::BUTTON_RELEASED;
+            for( size_t j=0; j<6; j++ )
+                { event.data[j] = 0; }
+            event.button = packet[1];
+            event.period = 0;
+        }
+        else
+            { continue; }
+        decoded++;
+    }
+
+    // keep the partial packet for the next read
+    buffered -= count*PACKETSIZE;
+    if( 0 < buffered )
+        { memmove( buffer, buffer + count*PACKETSIZE, buffered ); }
+
+    return decoded;
+
+}
@@ -0,0 +1,376 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#include <saw3Dconnexion/osa3DconnexionUdp.h>
+
+#include <cisstCommon/cmnLogger.h>
+
+#include <string.h>           // for memcpy/memset
+#include <stdlib.h>           // for strtol
+#include <errno.h>            // for errno
+#include <math.h>             // for ceil
+#include <stdint.h>           // for uint32_t/uint64_t
+#include <poll.h>             // for poll
+#include <unistd.h>           // for close
+#include <netdb.h>            // for getaddrinfo
+#include <sys/socket.h>       // for socket/bind/connect
+#include <netinet/in.h>       // for sockaddr_in
+
+enum { MAGIC = 'S', VERSION = 1 };
+// the sequence is reset if a packet is older than MAXAGE or after MAXLATE
+// late packets in a row, i.e. the sender was restarted
+enum { MAXAGE = 1024, MAXLATE = 8 };
+
+// little endian encoding
+static void Put32( unsigned char* buffer, uint32_t value ){
+    for( size_t i=0; i<4; i++ )
+        { buffer[i] = static_cast<unsigned char>( value >> ( 8*i ) ); }
+}
+
+static void Put64( unsigned char* buffer, uint64_t value ){
+    for( size_t i=0; i<8; i++ )
+        { buffer[i] = static_cast<unsigned char>( value >> ( 8*i ) ); }
+}
+
+static uint32_t Get32( const unsigned char* buffer ){
+    uint32_t value = 0;
+    for( size_t i=0; i<4; i++ )
+        { value |= static_cast<uint32_t>( buffer[i] ) << ( 8*i ); }
+    return value;
+}
+
+static uint64_t Get64( const unsigned char* buffer ){
+    uint64_t value = 0;
+    for( size_t i=0; i<8; i++ )
+        { value |= static_cast<uint64_t>( buffer[i] ) << ( 8*i ); }
+    return value;
+}
+
+static void PutFloat( unsigned char* buffer, float value ){
+    uint32_t bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    Put32( buffer, bits );
+}
+
+static void PutDouble( unsigned char* buffer, double value ){
+    uint64_t bits;
+    memcpy( &bits, &value, sizeof( bits ) );
+    Put64( buffer, bits );
+}
+
+static float GetFloat( const unsigned char* buffer ){
+    uint32_t bits = Get32( buffer );
+    float value;
+    memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+static double GetDouble( const unsigned char* buffer ){
+    uint64_t bits = Get64( buffer );
+    double value;
+    memcpy( &value, &bits, sizeof( value ) );
+    return value;
+}
+
+osa3DconnexionUdp::osa3DconnexionUdp() :
+    fd( -1 ),
+    sequence( 0 ),
+    synchronized( false ),
+    expected( 0 ),
+    window( 0 ),
+    late( 0 )
+{ ResetStatistics(); }
+
+osa3DconnexionUdp::~osa3DconnexionUdp()
+{ Close(); }
+
+bool osa3DconnexionUdp::Resolve( const std::string& address, void* addr ){
+
+    std::string host;
+    std::string port = address;
+    size_t colon = address.rfind( ':' );
+    if( colon != std::string::npos ){
+        host = address.substr( 0, colon );
+        port = address.substr( colon + 1 );
+    }
+    char* end = NULL;
+    long number = strtol( port.c_str(), &end, 10 );
+    if( port.empty() || *end != '\0' || number < 0 || 65535 < number )
+        { return false; }
+
+    struct sockaddr_in* in = static_cast<struct sockaddr_in*>( addr );
+    memset( in, 0, sizeof( *in ) );
+    in->sin_family = AF_INET;
+    in->sin_port = htons( static_cast<uint16_t>( number ) );
+    in->sin_addr.s_addr = htonl( INADDR_ANY );
+    if( host.empty() )
+        { return true; }
+
+    struct addrinfo hints;
+    memset( &hints, 0, sizeof( hints ) );
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    struct addrinfo* result = NULL;
+    if( getaddrinfo( host.c_str(), NULL, &hints, &result ) != 0 || result == NULL )
+        { return false; }
+    in->sin_addr = reinterpret_cast<struct sockaddr_in*>( result->ai_addr )->sin_addr;
+    freeaddrinfo( result );
+    return true;
+
+}
+
+osa3DconnexionUdp::Errno osa3DconnexionUdp::OpenSender( const std::string& destination ){
+
+    Close();
+
+    struct sockaddr_in addr;
+    if( !Resolve( destination, &addr ) || addr.sin_addr.s_addr == htonl( INADDR_ANY ) ){
+        CMN_LOG_RUN_ERROR << "Invalid destination " << destination
+                          << ", expected host:port" << std::endl;
+        return osa3DconnexionUdp::EFAILURE;
+    }
+
+    fd = socket( PF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0 );
+    if( fd == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to create socket" << std::endl;
+        return osa3DconnexionUdp::EFAILURE;
+    }
+    // connected so each packet is a single send
+    if( connect( fd, (struct sockaddr*)&addr, sizeof( addr ) ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to connect to " << destination << std::endl;
+        Close();
+        return osa3DconnexionUdp::EFAILURE;
+    }
+
+    sequence = 0;
+    return osa3DconnexionUdp::ESUCCESS;
+
+}
+
+osa3DconnexionUdp::Errno osa3DconnexionUdp::OpenReceiver( const std::string& address ){
+
+    Close();
+
+    struct sockaddr_in addr;
+    if( !Resolve( address, &addr ) ){
+        CMN_LOG_RUN_ERROR << "Invalid address " << address
+                          << ", expected port or host:port" << std::endl;
+        return osa3DconnexionUdp::EFAILURE;
+    }
+
+    fd = socket( PF_INET, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0 );
+    if( fd == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to create socket" << std::endl;
+        return osa3DconnexionUdp::EFAILURE;
+    }
+    if( bind( fd, (struct sockaddr*)&addr, sizeof( addr ) ) == -1 ){
+        CMN_LOG_RUN_ERROR << "Failed to bind " << address << std::endl;
+        Close();
+        return osa3DconnexionUdp::EFAILURE;
+    }
+
+    synchronized = false;
+    ResetStatistics();
+    return osa3DconnexionUdp::ESUCCESS;
+
+}
+
+osa3DconnexionUdp::Errno osa3DconnexionUdp::Close(){
+
+    if( fd != -1 ){
+        if( close( fd ) == -1 )
+            { CMN_LOG_RUN_ERROR << "Failed to close socket" << std::endl; }
+        fd = -1;
+    }
+    return osa3DconnexionUdp::ESUCCESS;
+
+}
+
+osa3DconnexionUdp::Errno osa3DconnexionUdp::Send( osa3DconnexionUdp::Packet& packet ){
+
+    if( fd == -1 )
+        { return osa3DconnexionUdp::EFAILURE; }
+
+    packet.sequence = sequence++;
+    unsigned char buffer[ SAMPLESIZE ];
+    size_t size = Encode( packet, buffer );
+    // the receiver may not be running (ECONNREFUSED) or the socket buffer
+    // full, the packet is then lost like any datagram
+    if( send( fd, buffer, size, 0 ) != static_cast<ssize_t>( size ) )
+        { return osa3DconnexionUdp::EFAILURE; }
+    return osa3DconnexionUdp::ESUCCESS;
+
+}
+
+size_t osa3DconnexionUdp::Receive( osa3DconnexionUdp::Packet* packets,
+                                   size_t maxpackets,
+                                   double timeout ){
+
+    if( fd == -1 || packets == NULL )
+        { return 0; }
+
+    if( BUFFERSIZE < maxpackets )
+        { maxpackets = BUFFERSIZE; }
+    if( maxpackets == 0 )
+        { return 0; }
+
+    // wait for data
+    int ms = -1;
+    if( 0.0 <= timeout )
+        { ms = static_cast<int>( ceil( timeout * 1000.0 ) ); }
+    struct pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int result = poll( &pfd, 1, ms );
+    while( result == -1 && errno == EINTR )
+        { result = poll( &pfd, 1, ms ); }
+    if( result <= 0 )
+        { return 0; }
+
+    // one datagram per packet, larger datagrams are truncated and invalid
+    size_t count = 0;
+    unsigned char buffer[ SAMPLESIZE + 1 ];
+    while( count < maxpackets ){
+        ssize_t n = recv( fd, buffer, sizeof( buffer ), 0 );
+        if( n == -1 ){
+            if( errno != EAGAIN && errno != EINTR )
+                { CMN_LOG_RUN_ERROR << "Failed to receive" << std::endl; }
+            break;
+        }
+        if( !Decode( buffer, n, packets[count] ) ){
+            statistics.invalid++;
+            continue;
+        }
+        statistics.received++;
+        if( Sequence( packets[count].sequence ) )
+            { count++; }
+    }
+    return count;
+
+}
+
+bool osa3DconnexionUdp::Sequence( unsigned int sequence ){
+
+    const int distance = static_cast<int>( sequence - expected );
+    if( !synchronized || distance < -MAXAGE || MAXLATE <= late ){
+        synchronized = true;
+        expected = sequence + 1;
+        window = 1;
+        late = 0;
+        return true;
+    }
+
+    // next or later packet, the gap is lost until late packets arrive
+    if( 0 <= distance ){
+        late = 0;
+        statistics.lost += distance;
+        window = ( distance < 63 ) ? ( ( window << ( distance + 1 ) ) | 1 ) : 1;
+        expected = sequence + 1;
+        return true;
+    }
+
+    // late packet, older than the window are assumed lost before
+    late++;
+    const unsigned int age = expected - 1 - sequence;
+    if( age < 64 ){
+        if( window & ( 1ULL << age ) ){
+            statistics.duplicated++;
+            return false;
+        }
+        window |= ( 1ULL << age );
+    }
+    statistics.reordered++;
+    if( 0 < statistics.lost )
+        { statistics.lost--; }
+    return false;
+
+}
+
+void osa3DconnexionUdp::ResetStatistics(){
+
+    statistics.received = 0;
+    statistics.lost = 0;
+    statistics.reordered = 0;
+    statistics.duplicated = 0;
+    statistics.invalid = 0;
+
+}
+
+size_t osa3DconnexionUdp::Encode( const osa3DconnexionUdp::Packet& packet,
+                                  unsigned char* buffer ){
+
+    buffer[0] = MAGIC;
+    buffer[1] = VERSION;
+    buffer[2] = ( packet.type == Packet::IDLE ) ? 1 : 0;
+    buffer[3] = packet.connected ? 1 : 0;
+    Put32( buffer + 4, packet.sequence );
+    Put64( buffer + 8, static_cast<uint64_t>( packet.utimestamp ) );
+    if( packet.type == Packet::IDLE ){
+        Put32( buffer + 16, packet.base );
+        return IDLESIZE;
+    }
+
+    unsigned char* data = buffer + 16;
+    for( size_t i=0; i<6; i++, data+=4 )
+        { PutFloat( data, packet.axis[i] ); }
+    Put32( data, packet.buttons );
+    data += 4;
+    for( size_t i=0; i<3; i++, data+=8 )
+        { PutDouble( data, packet.translation[i] ); }
+    for( size_t i=0; i<3; i++, data+=8 )
+        { PutDouble( data, packet.orientation[i] ); }
+    return SAMPLESIZE;
+
+}
+
+bool osa3DconnexionUdp::Decode( const unsigned char* buffer,
+                                size_t size,
+                                osa3DconnexionUdp::Packet& packet ){
+
+    if( size < IDLESIZE || buffer[0] != MAGIC || buffer[1] != VERSION )
+        { return false; }
+
+    packet.connected = ( buffer[3] != 0 );
+    packet.sequence = Get32( buffer + 4 );
+    packet.utimestamp = static_cast<long long>( Get64( buffer + 8 ) );
+    if( buffer[2] == 1 ){
+        if( size != IDLESIZE )
+            { return false; }
+        packet.type = Packet::IDLE;
+        packet.base = Get32( buffer + 16 );
+        return true;
+    }
+    if( buffer[2] != 0 || size != SAMPLESIZE )
+        { return false; }
+
+    packet.type = Packet::SAMPLE;
+    packet.base = packet.sequence;
+    const unsigned char* data = buffer + 16;
+    for( size_t i=0; i<6; i++, data+=4 )
+        { packet.axis[i] = GetFloat( data ); }
+    packet.buttons = Get32( data );
+    data += 4;
+    for( size_t i=0; i<3; i++, data+=8 )
+        { packet.translation[i] = GetDouble( data ); }
+    for( size_t i=0; i<3; i++, data+=8 )
+        { packet.orientation[i] = GetDouble( data ); }
+    return true;
+
+}
@@ -10,6 +10,8 @@ int main( int argc, char** argv ){
   cmnLogger::SetMaskDefaultLog( CMN_LOG_ALLOW_ALL );
 
   osa3Dconnexion spacenavigator;
+  // keep waiting if the device is unplugged
+  spacenavigator.SetHotplug( true );
   if( argc == 2 ){ 
     if( spacenavigator.Open( argv[1] ) != osa3Dconnexion::ESUCCESS ){
       std::cerr << "Failed to open device " << argv[1] << std::endl;
@@ -17,8 +19,17 @@ int main( int argc, char** argv ){
     }
   }
   else{
-    std::cerr << "Usage: " << argv[0] << " joystick_device_file" << std::endl;
-    return -1;
+    // use the first 3Dconnexion device found
+    std::vector<osa3Dconnexion::Descriptor> devices = osa3Dconnexion::Enumerate();
+    if( devices.empty() ){
+      std::cerr << "Usage: " << argv[0] << " [joystick_device_file]" << std::endl;
+      return -1;
+    }
+    std::cout << "Using " << devices[0].name << std::endl;
+    if( spacenavigator.Open( devices[0] ) != osa3Dconnexion::ESUCCESS ){
+      std::cerr << "Failed to open device " << devices[0].jsnode << std::endl;
+      return -1;
+    }
   }
     
   bool button1=false, button2=false;
@@ -0,0 +1,42 @@
+/* Print the samples published by mts3Dconnexion in shared memory, see
+   mts3Dconnexion::SetSharedMemory.  This example doesn't use cisst. */
+
+#define _POSIX_C_SOURCE 200112L
+#include <saw3Dconnexion/saw3DconnexionShm.h>
+#include <stdio.h>
+#include <time.h>
+
+int main( int argc, char** argv ){
+
+  const char* name = ( argc == 2 ) ? argv[1] : "/saw3Dconnexion";
+  saw3DconnexionShmReader reader;
+  saw3DconnexionShmSample sample;
+  uint64_t last = 0;
+  int printed = 0;  /* the first sample is numbered 0 */
+  struct timespec period = { 0, 10000000 };
+
+  if( saw3DconnexionShmOpen( name, &reader ) != 0 ){
+    fprintf( stderr, "Failed to open shared memory %s\n", name );
+    return -1;
+  }
+
+  for( ;; ){
+    // only print new samples
+    if( saw3DconnexionShmRead( &reader, &sample ) == 0
+        && ( !printed || sample.sequence != last ) ){
+      last = sample.sequence;
+      printed = 1;
+      printf( "%llu %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f buttons %x\n",
+              (unsigned long long)sample.sequence,
+              sample.axis[0], sample.axis[1], sample.axis[2],
+              sample.axis[3], sample.axis[4], sample.axis[5],
+              sample.buttons );
+      fflush( stdout );
+    }
+    nanosleep( &period, NULL );
+  }
+
+  saw3DconnexionShmClose( &reader );
+  return 0;
+
+}
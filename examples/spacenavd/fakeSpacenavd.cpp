@@ -0,0 +1,185 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+// Fake spacenavd replaying a script of packets to all its clients. The
+// script is a text file with one command per line:
+//   motion x y z rx ry rz [period]
+//   press button
+//   release button
+//   sleep seconds
+// Lines starting with # are ignored.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+struct Command{
+  int packet[8];   // packet sent to the clients
+  double sleep;    // or time to sleep in seconds
+};
+
+static bool Parse( std::istream& script, std::vector<Command>& commands ){
+  std::string line;
+  size_t number = 0;
+  while( std::getline( script, line ) ){
+    number++;
+    std::istringstream input( line );
+    std::string keyword;
+    if( !( input >> keyword ) || keyword[0] == '#' )
+      { continue; }
+
+    Command command;
+    memset( &command, 0, sizeof( command ) );
+    bool valid = true;
+    if( keyword == "motion" ){
+      command.packet[0] = 0;
+      for( size_t i=1; i<7; i++ )
+	{ valid = valid && ( input >> command.packet[i] ); }
+      if( !( input >> command.packet[7] ) )
+	{ command.packet[7] = 16; }
+    }
+    else if( keyword == "press" || keyword == "release" ){
+      command.packet[0] = ( keyword == "press" ) ? 1 : 2;
+      valid = static_cast<bool>( input >> command.packet[1] );
+    }
+    else if( keyword == "sleep" ){
+      command.packet[0] = -1;
+      valid = static_cast<bool>( input >> command.sleep );
+    }
+    else
+      { valid = false; }
+
+    if( !valid ){
+      std::cerr << "Invalid command on line " << number << ": " << line << std::endl;
+      return false;
+    }
+    commands.push_back( command );
+  }
+  return true;
+}
+
+static void Sleep( double seconds ){
+  struct timespec ts;
+  ts.tv_sec = static_cast<time_t>( seconds );
+  ts.tv_nsec = static_cast<long>( ( seconds - ts.tv_sec ) * 1e9 );
+  while( nanosleep( &ts, &ts ) == -1 ){}
+}
+
+int main( int argc, char** argv ){
+
+  std::string socketname = "/tmp/spnav.sock";
+  std::string scriptname;
+  size_t loops = 1;
+  size_t nclients = 1;
+  bool fast = false;
+
+  int c;
+  while( ( c = getopt( argc, argv, "s:n:c:x" ) ) != -1 ){
+    switch( c ){
+    case 's': socketname = optarg; break;
+    case 'n': loops = strtoul( optarg, NULL, 10 ); break;
+    case 'c': nclients = strtoul( optarg, NULL, 10 ); break;
+    case 'x': fast = true; break;
+    default:
+      std::cerr << "Usage: " << argv[0]
+		<< " [-s socket] [-n loops (0 forever)] [-c clients] [-x (ignore sleeps)] script"
+		<< std::endl;
+      return -1;
+    }
+  }
+  if( optind != argc - 1 ){
+    std::cerr << "Usage: " << argv[0]
+	      << " [-s socket] [-n loops (0 forever)] [-c clients] [-x (ignore sleeps)] script"
+	      << std::endl;
+    return -1;
+  }
+  scriptname = argv[optind];
+
+  std::vector<Command> commands;
+  std::ifstream script( scriptname.c_str() );
+  if( !script || !Parse( script, commands ) ){
+    std::cerr << "Failed to load " << scriptname << std::endl;
+    return -1;
+  }
+
+  // clients leaving must not kill the daemon
+  signal( SIGPIPE, SIG_IGN );
+
+  int server = socket( PF_UNIX, SOCK_STREAM, 0 );
+  struct sockaddr_un addr;
+  memset( &addr, 0, sizeof( addr ) );
+  addr.sun_family = AF_UNIX;
+  strncpy( addr.sun_path, socketname.c_str(), sizeof( addr.sun_path ) - 1 );
+  unlink( socketname.c_str() );
+  if( server == -1 ||
+      bind( server, (struct sockaddr*)&addr, sizeof( addr ) ) == -1 ||
+      listen( server, 16 ) == -1 ){
+    std::cerr << "Failed to create " << socketname << std::endl;
+    return -1;
+  }
+
+  // wait for the clients before replaying
+  std::vector<int> clients;
+  while( clients.size() < nclients ){
+    int client = accept( server, NULL, NULL );
+    if( client != -1 )
+      { clients.push_back( client ); }
+  }
+
+  size_t sent = 0;
+  for( size_t loop=0; loops == 0 || loop < loops; loop++ ){
+    for( size_t i=0; i<commands.size(); i++ ){
+      if( commands[i].packet[0] == -1 ){
+	if( !fast )
+	  { Sleep( commands[i].sleep ); }
+	continue;
+      }
+      for( size_t j=0; j<clients.size(); j++ ){
+	if( clients[j] != -1 &&
+	    write( clients[j], commands[i].packet, sizeof( commands[i].packet ) ) == -1 ){
+	  close( clients[j] );
+	  clients[j] = -1;
+	}
+      }
+      sent++;
+    }
+  }
+
+  std::cout << "Sent " << sent << " packets to " << clients.size() << " clients" << std::endl;
+
+  for( size_t j=0; j<clients.size(); j++ ){
+    if( clients[j] != -1 )
+      { close( clients[j] ); }
+  }
+  close( server );
+  unlink( socketname.c_str() );
+
+  return 0;
+}
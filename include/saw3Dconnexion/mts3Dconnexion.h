@@ -32,11 +32,9 @@ http://www.cisst.org/cisst/license.txt.
 
   \todo Can we activate the buttons from code, i.e. not using external 3Dconnexion control panel.
   \todo Use prm type for API? At osa level, use vctTypes?
-  \todo Add calibrate/bias function.
   \todo Add bypassing wizard settings, looks like overall speed setting should be at max, button numbers, ...
   \todo Test connection robustness.
   \todo Standardize values. (max is 1600 with full speed setting for both trans and rot).
-  \todo Add button events.
   \todo Check update rate seems sluggish with latency.
   \todo Remove the loop timer, use the automatic one.
   \todo Use wizard to set the buttons to 1, and 2 (keystroke #s).
@@ -47,57 +45,294 @@ http://www.cisst.org/cisst/license.txt.
 
 #include <cisstMultiTask/mtsTaskPeriodic.h>
 #include <cisstMultiTask/mtsVector.h>
+#include <cisstMultiTask/mtsMatrix.h>
+#include <cisstMultiTask/mtsFunctionWrite.h>
+#include <cisstVector/vctFixedSizeVectorTypes.h>
 #include <cisstParameterTypes/prmPositionCartesianGet.h>
+#include <saw3Dconnexion/mts3DconnexionState.h>
+#include <saw3Dconnexion/mts3DconnexionConditioning.h>
 #include <saw3Dconnexion/saw3DconnexionExport.h>  // always include last
 
 
 class mts3DconnexionData;  // class containing OS specific data
+struct mts3DconnexionSample;  // timestamped sample read from the device
 
 
+/*!
+  By default, the component is a periodic task.  When created event
+  driven (Linux with spacenavd only), the task runs continuously: Run
+  sleeps on the spacenavd socket (or on the reader thread ring) and
+  processes input as soon as it arrives, the period is then only used to
+  bound the latency of queued commands.
+
+  Run is the only writer of the state and the state table.  Input
+  delivered by another thread (Cocoa callbacks on Mac) is latched in a
+  snapshot and processed by Run, and GetAxisData and
+  GetPositionCartesian copy the latest output snapshot without locks so
+  any number of consumers can read concurrently.
+*/
 class CISST_EXPORT mts3Dconnexion: public mtsTaskPeriodic
 {
     CMN_DECLARE_SERVICES(CMN_DYNAMIC_CREATION_ONEARG, CMN_LOG_ALLOW_DEFAULT);
 
-    // platform "friendly" message handler for Cocoa events on Mac
-    friend void mts3DconnexionInternalMessageHandler(mts3Dconnexion * instance, const vctDynamicVector<double> & axis, const vctDynamicVector<bool> & buttons);
+    // platform "friendly" message handler for Cocoa events on Mac, fixed
+    // size arguments so handling a message doesn't allocate, only latches
+    // the input for Run
+    friend void mts3DconnexionInternalMessageHandler(mts3Dconnexion * instance, const vct6 & axis, const vctFixedSizeVector<bool, 2> & buttons);
 
  public:
-    /*! Constructors */
-    mts3Dconnexion(const std::string & taskName, double period) :
-        mtsTaskPeriodic(taskName, period, false, 500) {}
-    mts3Dconnexion(const mtsTaskPeriodicConstructorArg & arg) :
-        mtsTaskPeriodic(arg) {}
+    /*! Fixed size device state, 6 axes and 2 buttons */
+    typedef mts3DconnexionSpaceNavigatorState StateType;
+    typedef mts3DconnexionConditioning<StateType::NumAxes> ConditioningType;
+
+    /*! Constructors, an event driven component wakes up as soon as the
+        device has data instead of once per period (only supported with
+        spacenavd on Linux, periodic otherwise). */
+    mts3Dconnexion(const std::string & taskName, double period, bool eventDriven = false) :
+        mtsTaskPeriodic(taskName, CheckEventDriven(eventDriven) ? 0.0 : period, false, 500),
+        Period(period),
+        EventDriven(CheckEventDriven(eventDriven)) { Init(); }
+    mts3Dconnexion(const mtsTaskPeriodicConstructorArg & arg, bool eventDriven = false) :
+        mtsTaskPeriodic(arg.Name, CheckEventDriven(eventDriven) ? 0.0 : arg.Period,
+                        arg.IsHardRealTime, arg.StateTableSize),
+        Period(arg.Period),
+        EventDriven(CheckEventDriven(eventDriven)) { Init(); }
 
     /*! Destructor */
     ~mts3Dconnexion(void) {}
 
     /*! Device needs to be configured on the thread running the event loop
-        (main thread) on Mac. */
-    void Configure(const std::string & CMN_UNUSED(configurationName) = "");
+        (main thread) on Mac.  On Linux, each component owns its connection
+        to spacenavd and "spacenavd:<socket>" can be used to select a socket
+        other than /var/run/spnav.sock.  "replay:<log>" replays a log
+        created with SetRecording instead of connecting to spacenavd.
+        "js:<device>" and "evdev:<device>" read a joystick or event device
+        (or a FIFO of raw events) directly and "virtual:<profile>" reads
+        events generated by osa3DconnexionGenerator, i.e. "virtual:sinusoid:1000".
+        The device can be followed by comma separated conditioning options
+        (see mts3DconnexionConditioning): "range=<counts>" (32767 for
+        "js:", 350 for spacenavd and "evdev:" and 1600 on Windows by default),
+        "deadzone=<counts>" or "deadzone=<x>:<y>:<z>:<rx>:<ry>:<rz>",
+        "curve=<exponent>", "filter=none|lowpass|oneeuro",
+        "cutoff=<Hz>", "beta=<coefficient>" and "dcutoff=<Hz>", i.e.
+        "spacenavd,deadzone=15,curve=2,filter=oneeuro,cutoff=1,beta=0.01".
+        The integration of the position uses "vscale=<translation>:<rotation>"
+        (velocity per axis unit, per second) and "vmax=<translation>:<rotation>"
+        (velocity limits, 0 for none), see mts3DconnexionState::Integrate.
+        The bias uses "biaswindow=<s>" and
+        "drift=<time constant>:<threshold>:<rest time>" (time constant 0
+        to disable drift compensation).  "eventrate=<Hz>" sets the
+        maximum rate of MotionEvent (0 for no limit). */
+    void Configure(const std::string & CMN_UNUSED(configuration) = "");
     /*! Device needs to be configured on the component thread on Windows. */
     void Startup(void);
     void Run(void);
     void Cleanup(void);
 
-    void ReBias(void) {
-        CMN_LOG_CLASS_RUN_ERROR << "ReBias not implemented" << std::endl;
-    }
+    /*! Start computing the bias, i.e. the mean of the counts over the
+        bias window (see SetBiasWindow), without blocking.  The bias is
+        removed from the counts once the window is over. */
+    void ReBias(void);
+
+    /*! Policy used when the reader thread ring buffer is full.  With
+        KEEP_ALL, Run processes every sample and new samples are dropped
+        when the ring is full.  With KEEP_LATEST, Run only processes the
+        most recent motion sample and all the button samples: when the
+        ring is full, the reader keeps the button samples and the latest
+        motion sample between them aside, in order, until there is room
+        in the ring.  Button samples are only lost if the component is
+        stalled with more than 128 of them aside. */
+    typedef enum {KEEP_ALL, KEEP_LATEST} BackpressureType;
+
+    /*! Read the device from a dedicated thread which pushes timestamped
+        samples in a lock-free single producer/single consumer ring
+        buffer consumed by Run.  This must be called before Startup and is
+        only supported with spacenavd on Linux. */
+    void SetReaderThread(bool enable, size_t ringSize = 256,
+                         BackpressureType backpressure = KEEP_ALL);
+
+    /*! Append the raw events received from spacenavd to a binary log
+        (see osa3DconnexionLog).  This must be called before Startup and is
+        only supported with spacenavd on Linux. */
+    void SetRecording(const std::string & fileName);
+
+    /*! Publish the latest sample (axes, buttons, position and a
+        sequence number) in the POSIX shared memory segment name, i.e.
+        "/saw3Dconnexion", for processes which don't use cisst (see
+        saw3DconnexionShm.h).  The segment is removed in Cleanup.  This
+        must be called before Startup and is only supported on Linux. */
+    void SetSharedMemory(const std::string & name);
+
+    /*! Stream the samples to destination, "host:port", in UDP datagrams
+        (see osa3DconnexionUdp) received by mts3DconnexionReceiver on
+        another host.  A sample packet is sent for each change of the
+        axes, buttons or position, then idle packets at least every
+        100 ms.  This must be called before Startup and is only supported
+        on Linux. */
+    void SetStreaming(const std::string & destination);
+
+    /*! Rate used when replaying a log, 1 for real time (default), N for N
+        times faster and 0 to replay as fast as possible.  This must be
+        called before Startup. */
+    void SetReplayRate(double rate);
+
+    /*! Layout of the vector returned by the command
+        GetLatencyStatistics.  Latencies are in seconds: READ from the
+        device timestamp to the read (0 with spacenavd which doesn't
+        forward the device time), ADVANCE from the read to the state table
+        Advance and CONSUMER from Advance to the first call to GetAxisData
+        or GetPositionCartesian.  Rates are in samples per second since
+        Startup or the last ResetLatencyStatistics.  Only measured with
+        spacenavd on Linux. */
+    typedef enum {READ_P50, READ_P99, READ_MAX,
+                  ADVANCE_P50, ADVANCE_P99, ADVANCE_MAX,
+                  CONSUMER_P50, CONSUMER_P99, CONSUMER_MAX,
+                  MOTION_RATE, BUTTON_RATE,
+                  LATENCY_STATISTICS_SIZE} LatencyStatisticsType;
+
+    /*! Columns of the matrix returned by the command GetButtonEdgesSince:
+        edge index, button index, 1 if pressed or 0 if released and
+        timestamp. */
+    typedef enum {EDGE_INDEX, EDGE_BUTTON, EDGE_PRESSED, EDGE_TIMESTAMP, EDGE_SIZE} ButtonEdgeType;
+
+    /*! Columns of the matrix returned by the command GetAxisHistorySince:
+        record index, timestamp, robot axes and buttons bitmask. */
+    typedef enum {HISTORY_INDEX, HISTORY_TIMESTAMP, HISTORY_AXIS,
+                  HISTORY_BUTTONS = HISTORY_AXIS + StateType::NumAxes,
+                  HISTORY_SIZE} HistoryRecordType;
+
+    /*! Layout of the vector used by the commands GetFilter and SetFilter,
+        the type is 0 for none, 1 for low-pass and 2 for One-Euro. */
+    typedef enum {FILTER_TYPE, FILTER_CUTOFF, FILTER_BETA,
+                  FILTER_DERIVATIVE_CUTOFF, FILTER_SIZE} FilterSettingsType;
 
  protected:
+    void Init(void);
+    /*! False if event driven is requested but not supported, the task
+        period is then used. */
+    static bool CheckEventDriven(bool eventDriven);
+    void WaitForInput(void);
     void UpdateDataTable(void);
+    /*! Process the input latched by mts3DconnexionInternalMessageHandler
+        if any since the last call. */
+    void ProcessInput(void);
+    /*! Transform the axes of a batch of samples (see
+        mts3DconnexionState::Apply), then advance the state table for each
+        sample. */
+    void ProcessSamples(mts3DconnexionSample * samples, size_t count);
+    void ProcessSample(const mts3DconnexionSample & sample);
+    /*! Copy the state to the state table, the history and the output
+        snapshot. */
+    void CopyState(double time);
+    /*! Set the transform from the component axes (first 3 translations,
+        last 3 rotations) to the robot axes, applied before the mask and
+        gain. */
+    void SetAxisTransform(const mtsDoubleMat & transform);
+    void UpdateTransform(void);
+    /*! Integrate the axes held and filter the last input again while
+        the device is idle, until the filter output settles. */
+    void UpdateIdle(void);
+    void ParseOptions(const std::string & options);
+    void CopySettings(void);
+    void SetCountRange(const mtsInt & range);
+    void SetDeadzone(const mtsDoubleVec & deadzone);
+    void SetResponseExponent(const mtsDouble & exponent);
+    void SetFilter(const mtsDoubleVec & filter);
+    void SetVelocityScale(const mtsDoubleVec & scale);
+    void SetVelocityLimits(const mtsDoubleVec & limits);
+    void SetBiasWindow(const mtsDouble & window);
+    /*! Time constant (s, 0 to disable), threshold (counts) and rest time
+        (s) of the drift compensation, see
+        mts3DconnexionConditioning::SetDriftCompensation. */
+    void SetDriftCompensation(const mtsDoubleVec & drift);
+    /*! Trigger MotionEvent with the latest axes if they changed since the
+        last event and the maximum event rate allows it, the motion in
+        between is coalesced. */
+    void UpdateMotionEvent(void);
+    /*! Send a sample packet if the state changed since the last one,
+        else an idle packet if a sample was advanced or the keep alive
+        period is over. */
+    void UpdateStream(double time, bool advanced);
+    /*! Queue the button edge for GetButtonEdgesSince and trigger ButtonPressed
+        or ButtonReleased with the button index. */
+    void ButtonEvent(int button, bool pressed, double time);
+    void SetMotionEventRate(const mtsDouble & rate);
+    /*! Reconnect to spacenavd if needed and update IsConnected as soon
+        as spacenavd or the device (using udev) is lost or back. */
+    void UpdateConnection(void);
+
+    void GetAxisData(mtsDoubleVec & axis) const;
+    void GetPositionCartesian(prmPositionCartesianGet & position) const;
+    /*! Button edges queued since index, oldest first, one per row (see
+        ButtonEdgeType).  Like GetAxisHistorySince, each edge gets the next
+        index so each consumer keeps its own position and the edges are
+        never removed by a read.  The last 256 edges are kept, older edges
+        are lost and the first index returned is then greater than
+        requested. */
+    void GetButtonEdgesSince(const mtsULong & index, mtsDoubleMat & edges) const;
+    /*! Records of the state advanced since index, one per row (see
+        HistoryRecordType), in one call.  Each sample advanced gets the
+        next index, starting from 0, so the next call can start from the
+        last index returned plus one.  The history has the length of the
+        state table, older records are lost and the first index returned
+        is then greater than requested. */
+    void GetAxisHistorySince(const mtsULong & index, mtsDoubleMat & records) const;
+    void GetLatencyStatistics(mtsDoubleVec & statistics) const;
+    void ResetLatencyStatistics(void);
 
     mtsStateTable * DataTable;  // store data in separate state table
     mtsDoubleVec Axis;
     mtsBoolVec Buttons;
+    mtsUInt ButtonMask;  // bit i for button i
     mtsBoolVec Mask;
     mtsDouble Gain;
+    mtsDoubleMat AxisTransform;
+    mtsInt CountRange;
+    mtsDoubleVec Deadzone;
+    mtsDouble ResponseExponent;
+    mtsDoubleVec Filter;
+    mtsDoubleVec VelocityScale;   // translation and rotation
+    mtsDoubleVec VelocityLimits;  // translation and rotation
+    mtsDoubleVec Bias;            // counts removed from each axis
+    mtsDouble BiasWindow;
+    mtsDoubleVec DriftCompensation;  // time constant, threshold and rest time
+    mtsDouble MotionEventRate;    // maximum rate of MotionEvent, 0 for no limit
+
+    // events, payloads are preallocated and timestamped
+    mtsFunctionWrite MotionEvent;
+    mtsFunctionWrite ButtonPressed;
+    mtsFunctionWrite ButtonReleased;
+    mtsDoubleVec EventAxis;
+    mtsInt EventButton;
+    StateType::ButtonsType EventButtons;  // buttons reported when polled
+    double LastMotionEvent;
+    bool MotionPending;
     prmPositionCartesianGet Position;
     mtsBool IsConnected;
 
     mts3DconnexionData * Data;
     std::string ConfigurationName;  // this is the name used to load the configuration settings from the 3dCon application
-    vct3 Translation;
-    vct3 Orientation;
+    StateType State;  // axes and buttons read, state table vectors are copies
+    StateType::TransformType DeviceTransform;  // device to component axes
+    ConditioningType Conditioning;  // deadzone, response curve and filter of the counts
+
+    // timing
+    double Period;
+    double NextWakeup;
+    bool EventDriven;
+
+    // reader thread settings and ring buffer statistics
+    bool UseReaderThread;
+    size_t RingSize;
+    BackpressureType Backpressure;
+    mtsUInt RingOccupancy;
+    mtsUInt RingOverflows;
+
+    // record and replay
+    std::string RecordingFile;
+    std::string SharedMemoryName;
+    std::string StreamDestination;
+    double ReplayRate;
 };
 
 CMN_DECLARE_SERVICES_INSTANTIATION(mts3Dconnexion);
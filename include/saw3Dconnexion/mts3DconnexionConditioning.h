@@ -0,0 +1,377 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _mts3DconnexionConditioning_h
+#define _mts3DconnexionConditioning_h
+
+#include <cisstCommon/cmnConstants.h>
+#include <cisstVector/vctFixedSizeVectorTypes.h>
+#include <vector>
+#include <cmath>
+
+/*!
+  Per axis conditioning of the raw device counts: a bias removed from
+  the counts, a deadzone and a response curve, precomputed in a lookup
+  table over the integer count range, followed by a low-pass or One-Euro
+  filter.
+
+  The bias is the mean of the counts over a time window started with
+  StartBias.  The device only reports changes so the counts are weighted
+  by the time they are held.  Drift compensation optionally moves the
+  bias towards the counts while the device is at rest, i.e. when all the
+  counts stay within a threshold of the bias for a given time.
+
+  Outside the deadzone d, a count x is mapped to
+  sign(x) * range * ((|x| - d) / (range - d))^exponent so the full range
+  is preserved.  An exponent of 1 is linear, larger exponents give more
+  resolution for small displacements.  Counts beyond the range saturate.
+  The lookup table is skipped when the deadzones are 0 and the exponent 1.
+
+  The One-Euro filter (Casiez et al., CHI 2012) is a low-pass filter
+  whose cutoff increases with the speed of the input: cutoff = minimum
+  cutoff + beta * |filtered derivative|.
+*/
+template <vct::size_type _numAxes>
+class mts3DconnexionConditioning
+{
+ public:
+    enum {NumAxes = _numAxes};
+    typedef vctFixedSizeVector<double, _numAxes> AxisType;
+
+    typedef enum {NONE, LOW_PASS, ONE_EURO} FilterType;
+
+ protected:
+    int Range;
+    AxisType Deadzone;
+    double Exponent;
+    bool UseTable;
+    std::vector<double> Table;  // NumAxes rows of 2 * Range + 1 counts
+
+    FilterType Filter;
+    double Cutoff;            // low-pass or One-Euro minimum cutoff (Hz)
+    double Beta;              // One-Euro speed coefficient
+    double DerivativeCutoff;  // One-Euro derivative cutoff (Hz)
+    bool Initialized;
+    double LastTime;
+    AxisType Input;           // last conditioned input, before the filter
+    AxisType Filtered;
+    AxisType Derivative;
+
+    AxisType Bias;
+    AxisType Reported;        // bias used for the last input
+    AxisType Raw;             // last counts received
+    double RawTime;           // time of the last counts received
+    bool Holding;             // RawTime is valid
+    double BiasWindow;        // duration of the mean (s)
+    bool Capturing;
+    double CaptureEnd;
+    AxisType Sum;             // counts weighted by the time they were held
+    double SumTime;
+    double DriftTimeConstant; // 0 to disable drift compensation (s)
+    double DriftThreshold;    // largest difference to the bias at rest
+    double DriftRestTime;     // time at rest before tracking the drift (s)
+    double RestStart;         // start of the rest period, negative if moving
+
+    // account for the counts held since the last counts received, the
+    // counts are 0 until the device reports
+    void Hold(double time) {
+        if (!Holding) {
+            Holding = true;
+            RawTime = time;
+            return;
+        }
+        double dt = time - RawTime;
+        if (dt <= 0.0) {
+            return;
+        }
+        RawTime = time;
+        if (Capturing) {
+            const double remaining = CaptureEnd - (time - dt);
+            const double held = (dt < remaining) ? dt : remaining;
+            if (held > 0.0) {
+                for (vct::size_type i = 0; i < _numAxes; ++i) {
+                    Sum[i] += held * Raw[i];
+                }
+                SumTime += held;
+            }
+            if (time >= CaptureEnd) {
+                Capturing = false;
+                for (vct::size_type i = 0; i < _numAxes; ++i) {
+                    Bias[i] = (SumTime > 0.0) ? (Sum[i] / SumTime) : Raw[i];
+                }
+                RestStart = -1.0;
+            }
+            return;
+        }
+        if (DriftTimeConstant <= 0.0) {
+            return;
+        }
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            if (std::fabs(Raw[i] - Bias[i]) > DriftThreshold) {
+                RestStart = -1.0;
+                return;
+            }
+        }
+        if (RestStart < 0.0) {
+            RestStart = time - dt;
+        }
+        if ((time - RestStart) < DriftRestTime) {
+            return;
+        }
+        const double alpha = (dt < DriftTimeConstant) ? (dt / DriftTimeConstant) : 1.0;
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            Bias[i] += alpha * (Raw[i] - Bias[i]);
+        }
+    }
+
+    // smoothing factor of a first order low-pass filter
+    static double Alpha(double cutoff, double dt) {
+        const double tau = 1.0 / (2.0 * cmnPI * cutoff);
+        return 1.0 / (1.0 + tau / dt);
+    }
+
+    void Build(void) {
+        UseTable = (Exponent != 1.0);
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            UseTable = UseTable || (Deadzone[i] != 0.0);
+        }
+        if (!UseTable) {
+            return;
+        }
+        const size_t width = 2 * Range + 1;
+        Table.resize(_numAxes * width);
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            const double deadzone = (Deadzone[i] < Range) ? Deadzone[i] : Range;
+            for (int count = -Range; count <= Range; ++count) {
+                const double magnitude = std::fabs(static_cast<double>(count));
+                double value = 0.0;
+                if (magnitude > deadzone) {
+                    value = Range * std::pow((magnitude - deadzone) / (Range - deadzone), Exponent);
+                }
+                Table[i * width + count + Range] = (count < 0) ? -value : value;
+            }
+        }
+    }
+
+ public:
+    mts3DconnexionConditioning(void):
+        Range(350),
+        Exponent(1.0),
+        UseTable(false),
+        Filter(NONE),
+        Cutoff(10.0),
+        Beta(0.0),
+        DerivativeCutoff(1.0),
+        RawTime(0.0),
+        Holding(false),
+        BiasWindow(0.5),
+        Capturing(false),
+        CaptureEnd(0.0),
+        SumTime(0.0),
+        DriftTimeConstant(0.0),
+        DriftThreshold(5.0),
+        DriftRestTime(2.0),
+        RestStart(-1.0) {
+        Deadzone.SetAll(0.0);
+        Bias.SetAll(0.0);
+        Reported.SetAll(0.0);
+        Raw.SetAll(0.0);
+        Sum.SetAll(0.0);
+        Reset();
+    }
+
+    /*! Largest count reported by the device (350 for spacenavd). */
+    void SetRange(int range) {
+        Range = (range > 0) ? range : 1;
+        Build();
+    }
+    int GetRange(void) const { return Range; }
+
+    /*! Deadzone of each axis in counts (any vector with at least NumAxes
+        elements). */
+    template <class _vectorType>
+    void SetDeadzone(const _vectorType & deadzone) {
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            Deadzone[i] = (deadzone[i] > 0.0) ? deadzone[i] : 0.0;
+        }
+        Build();
+    }
+    const AxisType & GetDeadzone(void) const { return Deadzone; }
+
+    /*! Exponent of the response curve, 1 is linear. */
+    void SetExponent(double exponent) {
+        Exponent = (exponent > 0.0) ? exponent : 1.0;
+        Build();
+    }
+    double GetExponent(void) const { return Exponent; }
+
+    /*! Filter applied after the response curve.  For LOW_PASS, cutoff is
+        the cutoff frequency.  For ONE_EURO, cutoff is the minimum cutoff
+        frequency, beta the speed coefficient and derivativeCutoff the
+        cutoff frequency of the derivative. */
+    void SetFilter(FilterType filter, double cutoff, double beta, double derivativeCutoff) {
+        Filter = filter;
+        Cutoff = (cutoff > 0.0) ? cutoff : 1.0;
+        Beta = (beta > 0.0) ? beta : 0.0;
+        DerivativeCutoff = (derivativeCutoff > 0.0) ? derivativeCutoff : 1.0;
+        Reset();
+    }
+    FilterType GetFilter(void) const { return Filter; }
+    double GetCutoff(void) const { return Cutoff; }
+    double GetBeta(void) const { return Beta; }
+    double GetDerivativeCutoff(void) const { return DerivativeCutoff; }
+
+    /*! Duration of the mean computed by StartBias in seconds. */
+    void SetBiasWindow(double window) {
+        BiasWindow = (window > 0.0) ? window : 0.0;
+    }
+    double GetBiasWindow(void) const { return BiasWindow; }
+
+    /*! Start computing the mean of the counts received from time to time
+        plus the window, the bias is updated at the end of the window. */
+    void StartBias(double time) {
+        Hold(time);
+        Capturing = true;
+        CaptureEnd = time + BiasWindow;
+        Sum.SetAll(0.0);
+        SumTime = 0.0;
+    }
+    bool IsCapturing(void) const { return Capturing; }
+
+    /*! Track the drift of the bias while the counts stay within threshold
+        of the bias for restTime seconds, with a first order filter of
+        time constant timeConstant (0 to disable). */
+    void SetDriftCompensation(double timeConstant, double threshold, double restTime) {
+        DriftTimeConstant = (timeConstant > 0.0) ? timeConstant : 0.0;
+        DriftThreshold = (threshold > 0.0) ? threshold : 0.0;
+        DriftRestTime = (restTime > 0.0) ? restTime : 0.0;
+        RestStart = -1.0;
+    }
+    double GetDriftTimeConstant(void) const { return DriftTimeConstant; }
+    double GetDriftThreshold(void) const { return DriftThreshold; }
+    double GetDriftRestTime(void) const { return DriftRestTime; }
+
+    const AxisType & GetBias(void) const { return Bias; }
+
+    /*! Last counts received, before the bias. */
+    const AxisType & GetRaw(void) const { return Raw; }
+
+    /*! Update the bias up to time when no counts are received.  Returns
+        true if the bias changed by more than 0.01 count since the last
+        counts conditioned, i.e. the last counts should be conditioned
+        again. */
+    bool Update(double time) {
+        Hold(time);
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            if (std::fabs(Bias[i] - Reported[i]) > 0.01) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*! Restart the filter from the next sample. */
+    void Reset(void) {
+        Initialized = false;
+        LastTime = 0.0;
+        Input.SetAll(0.0);
+        Filtered.SetAll(0.0);
+        Derivative.SetAll(0.0);
+    }
+
+    /*! True if the filter output reached the last input, i.e. there is
+        no need to filter the last input again when the device is idle. */
+    bool IsSettled(void) const {
+        if (Filter == NONE) {
+            return true;
+        }
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            if (std::fabs(Filtered[i] - Input[i]) > 0.5) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*! Last input after the deadzone and response curve. */
+    const AxisType & GetInput(void) const { return Input; }
+
+    /*! Condition the counts of one sample in place.
+        \param axis Array of NumAxes counts
+        \param time Time of the sample in seconds, used by the filters */
+    void Apply(double * axis, double time) {
+        Hold(time);
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            Raw[i] = axis[i];
+            axis[i] -= Bias[i];
+        }
+        Reported = Bias;
+        if (UseTable) {
+            const size_t width = 2 * Range + 1;
+            for (vct::size_type i = 0; i < _numAxes; ++i) {
+                double count = std::floor(axis[i] + 0.5);
+                if (count > Range) {
+                    count = Range;
+                } else if (count < -Range) {
+                    count = -Range;
+                }
+                axis[i] = Table[i * width + static_cast<size_t>(count + Range)];
+            }
+        }
+        Smooth(axis, time);
+    }
+
+    /*! Filter conditioned counts in place, see Apply. */
+    void Smooth(double * axis, double time) {
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            Input[i] = axis[i];
+        }
+        if (Filter == NONE) {
+            return;
+        }
+        if (!Initialized) {
+            Initialized = true;
+            LastTime = time;
+            for (vct::size_type i = 0; i < _numAxes; ++i) {
+                Filtered[i] = axis[i];
+                Derivative[i] = 0.0;
+            }
+            return;
+        }
+        // samples read in the same batch can share the time
+        double dt = time - LastTime;
+        if (dt < 1.0e-4) {
+            dt = 1.0e-4;
+        }
+        LastTime = time;
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            double cutoff = Cutoff;
+            if (Filter == ONE_EURO) {
+                const double derivative = (axis[i] - Filtered[i]) / dt;
+                Derivative[i] += Alpha(DerivativeCutoff, dt) * (derivative - Derivative[i]);
+                cutoff += Beta * std::fabs(Derivative[i]);
+            }
+            Filtered[i] += Alpha(cutoff, dt) * (axis[i] - Filtered[i]);
+            axis[i] = Filtered[i];
+        }
+    }
+};
+
+#endif  // _mts3DconnexionConditioning_h
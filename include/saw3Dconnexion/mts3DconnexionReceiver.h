@@ -0,0 +1,119 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _mts3DconnexionReceiver_h
+#define _mts3DconnexionReceiver_h
+
+#include <cisstMultiTask/mtsTaskContinuous.h>
+#include <cisstMultiTask/mtsTaskPeriodic.h>
+#include <cisstMultiTask/mtsVector.h>
+#include <cisstMultiTask/mtsFunctionWrite.h>
+#include <cisstParameterTypes/prmPositionCartesianGet.h>
+#include <saw3Dconnexion/mts3Dconnexion.h>
+#include <saw3Dconnexion/osa3DconnexionUdp.h>
+#include <saw3Dconnexion/saw3DconnexionExport.h>  // always include last
+
+/*!
+  Receives the samples streamed by mts3Dconnexion (see
+  mts3Dconnexion::SetStreaming) on another host and provides the state
+  with the same "ProvidesSpaceNavigator" interface: GetAxisData,
+  GetButtonData, GetButtonMask, GetPositionCartesian, GetIsConnected
+  and the events MotionEvent, ButtonPressed and ButtonReleased.  The
+  settings of the device (gain, mask, conditioning...) are only
+  available on the sending component.
+
+  The task sleeps on the socket and processes the packets as soon as
+  they arrive; the period is only used to bound the latency of queued
+  commands.  The state is advanced once per Run with the latest packet.
+  The events are timestamped with the local time the packets were
+  received, the time of the sender is only provided by GetSourceTime.
+  Packets lost or reordered in the network are counted, see
+  GetStreamStatistics.
+*/
+class CISST_EXPORT mts3DconnexionReceiver: public mtsTaskContinuous
+{
+    CMN_DECLARE_SERVICES(CMN_DYNAMIC_CREATION_ONEARG, CMN_LOG_ALLOW_DEFAULT);
+
+ public:
+    typedef mts3Dconnexion::StateType StateType;
+
+    /*! Constructors */
+    mts3DconnexionReceiver(const std::string & taskName, double period) :
+        mtsTaskContinuous(taskName, 500),
+        Period(period) { Init(); }
+    mts3DconnexionReceiver(const mtsTaskPeriodicConstructorArg & arg) :
+        mtsTaskContinuous(arg.Name, arg.StateTableSize),
+        Period(arg.Period) { Init(); }
+
+    /*! Destructor */
+    ~mts3DconnexionReceiver(void) {}
+
+    /*! Address the packets are sent to, "port" or "host:port", i.e.
+        "7700" to receive on all the interfaces. */
+    void Configure(const std::string & address = "");
+    void Startup(void);
+    void Run(void);
+    void Cleanup(void);
+
+    /*! Layout of the vector returned by the command GetStreamStatistics,
+        numbers of packets since Startup or the last
+        ResetStreamStatistics.  UNSYNCHRONIZED counts the idle packets
+        referring to a sample packet which was lost, the state may then
+        be stale until the sender repeats the sample. */
+    typedef enum {STREAM_RECEIVED, STREAM_LOST, STREAM_REORDERED,
+                  STREAM_DUPLICATED, STREAM_INVALID, STREAM_UNSYNCHRONIZED,
+                  STREAM_SIZE} StreamStatisticsType;
+
+ protected:
+    void Init(void);
+    void ProcessPacket(const osa3DconnexionUdp::Packet & packet, double time);
+    void GetStreamStatistics(mtsDoubleVec & statistics) const;
+    void ResetStreamStatistics(void);
+
+    std::string Address;
+    osa3DconnexionUdp Socket;
+    osa3DconnexionUdp::Packet Packets[osa3DconnexionUdp::BUFFERSIZE];
+    unsigned int Base;     // sequence of the last sample packet processed
+    bool HasBase;
+    unsigned long long Unsynchronized;
+    double LastReceived;   // time of the last packet
+    double Timeout;        // disconnected without packets for this time (s)
+
+    mtsDoubleVec Axis;
+    mtsBoolVec Buttons;
+    mtsUInt ButtonMask;  // bit i for button i
+    prmPositionCartesianGet Position;
+    mtsBool IsConnected;
+    mtsDouble SourceTime;  // sender time of the last packet (s)
+
+    // events, payloads are preallocated and timestamped with the local
+    // time of reception
+    mtsFunctionWrite MotionEvent;
+    mtsFunctionWrite ButtonPressed;
+    mtsFunctionWrite ButtonReleased;
+    mtsDoubleVec EventAxis;
+    mtsInt EventButton;
+
+    double Period;
+};
+
+CMN_DECLARE_SERVICES_INSTANTIATION(mts3DconnexionReceiver);
+
+#endif  // _mts3DconnexionReceiver_h
@@ -0,0 +1,97 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _mts3DconnexionSnapshot_h
+#define _mts3DconnexionSnapshot_h
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define MTS3DCONNEXION_BARRIER() MemoryBarrier()
+#else
+#define MTS3DCONNEXION_BARRIER() __sync_synchronize()
+#endif
+
+/*!
+  Latest value written by a single writer and read by any number of
+  readers without locks.  The value is double buffered under a sequence
+  counter: the writer updates the first buffer while the sequence is odd
+  and the second one while it is even so a reader always finds a
+  complete copy, i.e. it never spins while a value is written.  Writing
+  never waits and a reader only retries if the writer started to
+  overwrite the copy it was reading.
+
+  _elementType must be copyable with an assignment and shouldn't own heap
+  storage (plain structure of doubles and integers).
+*/
+template <class _elementType>
+class mts3DconnexionSnapshot
+{
+ public:
+    typedef _elementType ElementType;
+
+    mts3DconnexionSnapshot(void):
+        Sequence(0) {
+        Buffers[0] = ElementType();
+        Buffers[1] = ElementType();
+    }
+
+    /*! Publish a value, single writer only. */
+    void Write(const ElementType & element) {
+        // the previous copy to the second buffer must be complete before
+        // readers are sent to it
+        MTS3DCONNEXION_BARRIER();
+        Sequence = Sequence + 1;
+        MTS3DCONNEXION_BARRIER();
+        Buffers[0] = element;
+        MTS3DCONNEXION_BARRIER();
+        Sequence = Sequence + 1;
+        MTS3DCONNEXION_BARRIER();
+        Buffers[1] = element;
+    }
+
+    /*! Copy the latest value, returns the number of values written
+        before it so a reader can tell if the value changed since its
+        last read. */
+    unsigned int Read(ElementType & element) const {
+        unsigned int before, after;
+        do {
+            before = Sequence;
+            MTS3DCONNEXION_BARRIER();
+            element = Buffers[before & 1];
+            MTS3DCONNEXION_BARRIER();
+            after = Sequence;
+        } while (after != before);
+        return before / 2;
+    }
+
+    /*! Number of values written so far, a value being written is not
+        counted. */
+    unsigned int GetVersion(void) const {
+        const unsigned int sequence = Sequence;
+        MTS3DCONNEXION_BARRIER();
+        return sequence / 2;
+    }
+
+ private:
+    volatile unsigned int Sequence;
+    ElementType Buffers[2];
+};
+
+#endif  // _mts3DconnexionSnapshot_h
@@ -0,0 +1,254 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _mts3DconnexionState_h
+#define _mts3DconnexionState_h
+
+#include <cisstVector/vctFixedSizeVectorTypes.h>
+#include <cisstVector/vctFixedSizeMatrixTypes.h>
+
+/*!
+  Fixed size state of a 3Dconnexion device.  The number of axes and
+  buttons are template parameters so the state is a flat object without
+  heap storage and the transform and integration loops have compile time
+  bounds.  The first three axes are translations and the next three
+  rotations.  The buttons are a bitmask, bit i for button i.
+
+  The device axes are mapped to the robot axes with a square transform.
+  The axis mask and the gain are folded in the transform rows when any of
+  them changes so applying them costs one matrix-vector product per
+  sample, also available for a batch of samples.
+
+  The position is integrated as velocity x dt using the time of each
+  sample so it doesn't depend on the rate of the device or of the
+  component: the robot axes are held between samples, scaled to
+  velocities (per second) and clamped.
+
+  \sa mts3DconnexionSpaceNavigatorState
+*/
+template <vct::size_type _numAxes, vct::size_type _numButtons>
+class mts3DconnexionState
+{
+ public:
+    enum {NumAxes = _numAxes, NumButtons = _numButtons};
+
+    typedef vctFixedSizeVector<double, _numAxes> AxisType;
+    typedef unsigned int ButtonsType;
+    // compile time check, the buttons must fit in the bitmask
+    typedef char ButtonsFitInMask[(_numButtons <= 8 * sizeof(ButtonsType)) ? 1 : -1];
+    typedef vctFixedSizeMatrix<double, _numAxes, _numAxes> TransformType;
+
+    AxisType Input;        // axes read from the device
+    AxisType Axis;         // robot axes after transform, mask and gain
+    AxisType Scale;        // gain for the enabled axes, 0 for masked axes
+    TransformType Transform;  // device to robot axes
+    TransformType Combined;   // transform rows multiplied by the scale
+    ButtonsType Buttons;   // bitmask of the buttons pressed
+    vct3 Translation;      // integrated translation axes
+    vct3 Orientation;      // integrated rotation axes
+
+    double TranslationScale;  // velocity per unit of translation axis
+    double RotationScale;     // velocity per unit of rotation axis
+    double MaxTranslation;    // translation velocity limit, 0 for none
+    double MaxRotation;       // rotation velocity limit, 0 for none
+    double MaxStep;           // longest time step integrated (s)
+    double LastTime;          // time of the last integration (s)
+    bool Integrating;         // LastTime is valid
+
+    mts3DconnexionState(void):
+        TranslationScale(1.0),
+        RotationScale(1.0),
+        MaxTranslation(0.0),
+        MaxRotation(0.0),
+        MaxStep(0.1),
+        LastTime(0.0),
+        Integrating(false) {
+        Input.SetAll(0.0);
+        Axis.SetAll(0.0);
+        Scale.SetAll(1.0);
+        Transform.SetAll(0.0);
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            Transform.Element(i, i) = 1.0;
+        }
+        Combined = Transform;
+        Buttons = 0;
+        Translation.SetAll(0.0);
+        Orientation.SetAll(0.0);
+    }
+
+    /*! Button state, button must be less than NumButtons. */
+    bool GetButton(vct::size_type button) const {
+        return (Buttons & (1u << button)) != 0;
+    }
+    void SetButton(vct::size_type button, bool pressed) {
+        if (pressed) {
+            Buttons |= (1u << button);
+        } else {
+            Buttons &= ~(1u << button);
+        }
+    }
+
+    /*! Set all the buttons from a vector of booleans with at least
+        NumButtons elements. */
+    template <class _vectorType>
+    void SetButtons(const _vectorType & buttons) {
+        for (vct::size_type i = 0; i < _numButtons; ++i) {
+            SetButton(i, buttons[i]);
+        }
+    }
+
+    /*! Set the device to robot transform (any matrix with at least
+        NumAxes rows and columns). */
+    template <class _matrixType>
+    void SetTransform(const _matrixType & transform) {
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            for (vct::size_type j = 0; j < _numAxes; ++j) {
+                Transform.Element(i, j) = transform(i, j);
+            }
+        }
+        Combine();
+    }
+
+    /*! Fold the axis mask (any vector of booleans with at least NumAxes
+        elements) and the gain in the transform, only if they changed. */
+    template <class _maskType>
+    void SetMaskAndGain(const _maskType & mask, double gain) {
+        bool changed = false;
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            const double scale = mask[i] ? gain : 0.0;
+            changed = changed || (scale != Scale[i]);
+            Scale[i] = scale;
+        }
+        if (changed) {
+            Combine();
+        }
+    }
+
+    /*! Multiply the transform rows by the scale. */
+    void Combine(void) {
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            for (vct::size_type j = 0; j < _numAxes; ++j) {
+                Combined.Element(i, j) = Scale[i] * Transform.Element(i, j);
+            }
+        }
+    }
+
+    /*! Apply the transform, mask and gain in place to a batch of samples,
+        _sampleType must have an array Axis of NumAxes doubles.  The loops
+        have compile time bounds so the compiler can unroll and vectorize
+        them. */
+    template <class _sampleType>
+    void Apply(_sampleType * samples, size_t count) const {
+        for (size_t k = 0; k < count; ++k) {
+            double input[_numAxes];
+            for (vct::size_type j = 0; j < _numAxes; ++j) {
+                input[j] = samples[k].Axis[j];
+            }
+            for (vct::size_type i = 0; i < _numAxes; ++i) {
+                double output = 0.0;
+                for (vct::size_type j = 0; j < _numAxes; ++j) {
+                    output += Combined.Element(i, j) * input[j];
+                }
+                samples[k].Axis[i] = output;
+            }
+        }
+    }
+
+    /*! Integrate the axes up to time, then apply the transform, mask and
+        gain to the input. */
+    void Update(double time) {
+        Integrate(time);
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            double output = 0.0;
+            for (vct::size_type j = 0; j < _numAxes; ++j) {
+                output += Combined.Element(i, j) * Input[j];
+            }
+            Axis[i] = output;
+        }
+    }
+
+    /*! Scale of the velocities, i.e. velocity = scale * axis. */
+    void SetVelocityScale(double translation, double rotation) {
+        TranslationScale = translation;
+        RotationScale = rotation;
+    }
+
+    /*! Limit of the velocity of each axis, 0 for no limit. */
+    void SetVelocityLimits(double translation, double rotation) {
+        MaxTranslation = (translation > 0.0) ? translation : 0.0;
+        MaxRotation = (rotation > 0.0) ? rotation : 0.0;
+    }
+
+    /*! Integrate the current robot axes from the last integration to
+        time, in seconds.  Call before updating the axes with a new
+        sample.  Time steps are clamped between 0 and MaxStep so samples
+        out of order or a stalled component don't cause jumps. */
+    void Integrate(double time) {
+        if (!Integrating) {
+            Integrating = true;
+            LastTime = time;
+            return;
+        }
+        double dt = time - LastTime;
+        if (dt <= 0.0) {
+            return;
+        }
+        LastTime = time;
+        if (dt > MaxStep) {
+            dt = MaxStep;
+        }
+        for (vct::size_type i = 0; (i < 3) && (i < _numAxes); ++i) {
+            Translation[i] += Velocity(Axis[i], TranslationScale, MaxTranslation) * dt;
+        }
+        for (vct::size_type i = 3; (i < 6) && (i < _numAxes); ++i) {
+            Orientation[i - 3] += Velocity(Axis[i], RotationScale, MaxRotation) * dt;
+        }
+    }
+
+    /*! True if integrating the current robot axes moves the position. */
+    bool IsMoving(void) const {
+        for (vct::size_type i = 0; i < _numAxes; ++i) {
+            if (Axis[i] != 0.0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static double Velocity(double axis, double scale, double limit) {
+        const double velocity = scale * axis;
+        if (limit == 0.0) {
+            return velocity;
+        }
+        if (velocity > limit) {
+            return limit;
+        }
+        return (velocity < -limit) ? -limit : velocity;
+    }
+};
+
+//! SpaceNavigator, SpaceExplorer and SpacePilot as used by mts3Dconnexion
+typedef mts3DconnexionState<6, 2> mts3DconnexionSpaceNavigatorState;
+//! SpaceMouse Pro
+typedef mts3DconnexionState<6, 15> mts3DconnexionSpaceMouseProState;
+//! SpaceMouse Enterprise
+typedef mts3DconnexionState<6, 31> mts3DconnexionSpaceMouseEnterpriseState;
+
+#endif  // _mts3DconnexionState_h
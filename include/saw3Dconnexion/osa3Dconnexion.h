@@ -22,6 +22,8 @@ http://www.cisst.org/cisst/license.txt.
 
 #include <saw3Dconnexion/saw3DconnexionExport.h>
 #include <string>
+#include <vector>
+#include <cstddef>
 
 class CISST_EXPORT osa3Dconnexion {
 
@@ -29,6 +31,16 @@ class CISST_EXPORT osa3Dconnexion {
 
     enum Errno{ ESUCCESS, EFAILURE };
 
+    //! Kernel interface used to read the device
+    /**
+       JOYSTICK reads /dev/input/js? (millisecond timestamps, mapped to the
+       monotonic clock using the smallest delay observed). EVDEV reads the
+       corresponding /dev/input/event? (microsecond timestamps). REPLAY
+       reads the raw events of a log created with SetRecording (logged
+       timestamps).
+    */
+    enum Backend{ JOYSTICK, EVDEV, REPLAY };
+
     struct Event{
 
         enum Type { UNKNOWN, MOTION, BUTTON_PRESSED, BUTTON_RELEASED };
@@ -37,8 +49,24 @@ class CISST_EXPORT osa3Dconnexion {
 
         Type type;
         Button button;
-        Data data;
-        unsigned int timestamp;
+        Data data;                // accumulated value of each axis
+        Data values;              // last value reported by each axis
+        unsigned int buttons;     // bitmask of the buttons pressed
+        unsigned int timestamp;   // in milliseconds
+        long long utimestamp;     // in microseconds (monotonic clock)
+
+    };
+
+    //! Input device found in sysfs
+    struct Descriptor{
+
+        std::string jsnode;       // i.e. /dev/input/js0 (empty if none)
+        std::string eventnode;    // i.e. /dev/input/event5 (empty if none)
+        unsigned short vendor;    // USB vendor ID
+        unsigned short product;   // USB product ID
+        std::string name;         // name reported by the driver
+        size_t naxes;             // number of absolute or relative axes
+        size_t nbuttons;          // number of keys/buttons
 
     };
 
@@ -55,10 +83,114 @@ class CISST_EXPORT osa3Dconnexion {
     osa3Dconnexion();
     ~osa3Dconnexion();
 
-    osa3Dconnexion::Errno Open( const std::string& filename = "" );
+    //! Open the device
+    /**
+       \param filename The joystick device (/dev/input/js?). With the EVDEV
+                       backend, the event device (/dev/input/event?) can also
+                       be used. With the REPLAY backend, the log to replay.
+       \param backend The kernel interface used to read the data
+    */
+    osa3Dconnexion::Errno Open( const std::string& filename = "",
+                                osa3Dconnexion::Backend backend = JOYSTICK );
+
+    //! Open a device returned by Enumerate
+    /**
+       The joystick node is required by the JOYSTICK backend and the event
+       node by the EVDEV backend.
+    */
+    osa3Dconnexion::Errno Open( const osa3Dconnexion::Descriptor& descriptor,
+                                osa3Dconnexion::Backend backend = JOYSTICK );
+
+    //! Open a virtual device
+    /**
+       Read raw events (js_event with JOYSTICK, input_event with EVDEV) from
+       a FIFO, a pipe or a socket, i.e. fed by osa3DconnexionGenerator. The
+       file descriptor is duplicated and set non-blocking.
+    */
+    osa3Dconnexion::Errno Open( int fd, osa3Dconnexion::Backend backend = JOYSTICK );
     osa3Dconnexion::Errno Close();
 
-    osa3Dconnexion::Event WaitForEvent();
+    //! Wait for the next event
+    /**
+       \param timeout Time in seconds to wait for an event. A negative
+                      timeout blocks until an event is available.
+       \return The next event or an UNKNOWN event if the wait timed out or
+               was interrupted.
+    */
+    osa3Dconnexion::Event WaitForEvent( double timeout = -1.0 );
+
+    //! Emit a single motion event per device report
+    /**
+       By default, each axis update produces a motion event. When coalescing,
+       a motion event is produced once all the axes of a report have been
+       updated: at SYN_REPORT with the EVDEV backend or when the joystick
+       events stop sharing the same timestamp.
+    */
+    void SetCoalescing( bool coalesce );
+
+    //! Append the raw events read from the device to a log
+    /**
+       \param filename The log (see osa3DconnexionLog), an empty name stops
+                       the recording
+    */
+    osa3Dconnexion::Errno SetRecording( const std::string& filename );
+
+    //! Set the rate of the REPLAY backend
+    /**
+       \param rate 1 for real time (default), N for N times faster and 0 to
+                   replay as fast as possible
+    */
+    void SetReplayRate( double rate );
+
+    //! Replay from the given time (seconds since the first record)
+    osa3Dconnexion::Errno SeekReplay( double time );
+
+    //! Reopen the device automatically when it is plugged back
+    /**
+       When the device is unplugged, the file descriptors are closed and
+       the readers keep waiting until the device is plugged back. With
+       udev, the device is reopened as soon as it is reported, otherwise
+       the device file is checked periodically.
+    */
+    osa3Dconnexion::Errno SetHotplug( bool enable );
+
+    //! File descriptor polled for data, i.e. to wait in an event loop (-1
+    //! if closed or replaying)
+    int GetFileDescriptor() const;
+
+    //! Return true if the device is opened and plugged
+    bool IsConnected() const;
+
+    //! List the input devices with a single pass over /sys/class/input
+    /**
+       \param all List all the input devices instead of the 3Dconnexion ones
+    */
+    static std::vector<osa3Dconnexion::Descriptor> Enumerate( bool all = false );
+
+    //! Return true for USB IDs of 3Dconnexion devices
+    static bool IsSupported( unsigned short vendor, unsigned short product );
+
+    //! Unblock a thread waiting in WaitForEvent or ReadEvents
+    /**
+       This can be called from any thread. If no thread is waiting, the next
+       wait returns immediately.
+    */
+    osa3Dconnexion::Errno Interrupt();
+
+    //! Read all the events queued by the device
+    /**
+       Drain the events queued by the device with a single read and decode
+       them in a buffer provided by the caller. At most 64 events are read
+       per call.
+       \param events A buffer of at least maxevents events
+       \param maxevents The size of the buffer
+       \param timeout Time in seconds to wait for the first event. A
+                      negative timeout blocks until an event is available.
+       \return The number of events copied in the buffer
+    */
+    size_t ReadEvents( osa3Dconnexion::Event* events,
+                       size_t maxevents,
+                       double timeout = 0.0 );
 
 };
 
@@ -0,0 +1,110 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionGenerator_h
+#define _osa3DconnexionGenerator_h
+
+#include <cisstOSAbstraction/osaThread.h>
+#include <saw3Dconnexion/osa3Dconnexion.h>
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <string>
+
+//! Synthetic device feeding a virtual osa3Dconnexion
+/**
+   A thread writes raw events (js_event or input_event) in one end of a
+   socket pair while the device reads the other end with the same code
+   path as a real device. Reports are written in batches so rates of tens
+   of kHz can be sustained.
+*/
+class CISST_EXPORT osa3DconnexionGenerator {
+
+ public:
+
+    enum Errno{ ESUCCESS, EFAILURE };
+
+    struct Profile{
+
+        //! SINUSOID moves all the axes with phase shifts, STEP toggles all
+        //! the axes between 0 and the amplitude and BUTTONS presses and
+        //! releases the two buttons alternatively
+        enum Type { SINUSOID, STEP, BUTTONS };
+
+        Type type;
+        double rate;         // reports per second (0 as fast as possible)
+        double amplitude;    // axis amplitude
+        double frequency;    // sinusoid or step frequency (Hz)
+        size_t count;        // number of reports (0 until stopped)
+
+        Profile() :
+            type( SINUSOID ),
+            rate( 100.0 ),
+            amplitude( 350.0 ),
+            frequency( 1.0 ),
+            count( 0 ){}
+
+    };
+
+    //! Parse a profile "type[:rate[:amplitude[:frequency]]]"
+    /**
+       i.e. "sinusoid:1000", "step:500:200:2" or "buttons:20000"
+    */
+    static osa3DconnexionGenerator::Errno Parse( const std::string& description,
+                                                 osa3DconnexionGenerator::Profile& profile );
+
+ private:
+
+    osa3DconnexionGenerator::Profile profile;
+    osa3Dconnexion::Backend backend;  // format of the raw events
+    int fd;                           // end of the socket pair written
+    osaThread thread;
+    volatile bool stop;               // request the thread to stop
+    volatile bool running;            // the thread is generating
+    volatile unsigned long long generated; // number of reports written
+
+    void* Run( void* );
+
+    // Write the raw events of report k in the buffer, return the size
+    size_t Report( unsigned long long k, double start, char* buffer ) const;
+
+ public:
+
+    osa3DconnexionGenerator();
+    ~osa3DconnexionGenerator();
+
+    //! Open the device as a virtual device and start generating
+    /**
+       \param device A closed device
+       \param profile The events to generate
+       \param backend JOYSTICK or EVDEV events
+    */
+    osa3DconnexionGenerator::Errno Start( osa3Dconnexion& device,
+                                          const osa3DconnexionGenerator::Profile& profile,
+                                          osa3Dconnexion::Backend backend = osa3Dconnexion::JOYSTICK );
+
+    //! Stop generating, the device reads the end of the stream
+    osa3DconnexionGenerator::Errno Stop();
+
+    bool IsRunning() const { return running; }
+
+    //! Number of reports written so far
+    unsigned long long GetGenerated() const { return generated; }
+
+};
+
+#endif
@@ -0,0 +1,73 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionHistogram_h
+#define _osa3DconnexionHistogram_h
+
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <cstddef>
+
+//! Lock-free histogram of durations in microseconds
+/**
+   Durations are counted in log-linear buckets: each power of two is split
+   in 8 buckets so percentiles are within 12.5% of the exact value, from
+   1 microsecond to a few hours. Add only uses atomic operations and can be
+   called from several threads while another thread reads the statistics.
+*/
+class CISST_EXPORT osa3DconnexionHistogram {
+
+ public:
+
+    enum { SUBBUCKETS = 8, BUCKETS = 256 };
+
+ private:
+
+    volatile unsigned long long buckets[BUCKETS];
+    volatile unsigned long long count;   // number of durations added
+    volatile long long max;              // largest duration added
+
+    static size_t Bucket( long long usec );
+
+    // Largest duration counted in a bucket
+    static long long UpperBound( size_t bucket );
+
+ public:
+
+    osa3DconnexionHistogram();
+
+    //! Count a duration (negative durations are counted as 0)
+    void Add( long long usec );
+
+    //! Clear the histogram (durations added meanwhile can be lost)
+    void Reset();
+
+    unsigned long long GetCount() const { return count; }
+    long long GetMax() const { return max; }
+
+    //! Duration below which the given fraction of the durations are
+    /**
+       \param fraction i.e. 0.5 for the median or 0.99
+       \return The upper bound of the bucket (at most the maximum) or 0 if
+               the histogram is empty
+    */
+    long long GetPercentile( double fraction ) const;
+
+};
+
+#endif
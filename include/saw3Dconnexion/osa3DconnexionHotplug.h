@@ -0,0 +1,79 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionHotplug_h
+#define _osa3DconnexionHotplug_h
+
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <string>
+#include <vector>
+
+//! Monitor 3Dconnexion devices plugged and unplugged (udev netlink)
+/**
+   Only the input device nodes (/dev/input/js? and /dev/input/event?) of
+   USB devices made by 3Dconnexion are reported. A removed node which
+   can't be identified anymore is reported with vendor and product 0 so
+   the nodes tracked can be dropped. The monitor never blocks, its file
+   descriptor can be polled along with the data.
+*/
+class CISST_EXPORT osa3DconnexionHotplug {
+
+ public:
+
+    enum Errno{ ESUCCESS, EFAILURE };
+
+    struct Event{
+
+        enum Type { ADDED, REMOVED };
+
+        Type type;
+        std::string devnode;     // i.e. /dev/input/js0
+        unsigned short vendor;   // USB vendor ID
+        unsigned short product;  // USB product ID
+
+    };
+
+ private:
+
+    struct Internals;
+    osa3DconnexionHotplug::Internals* internals;
+
+ public:
+
+    osa3DconnexionHotplug();
+    ~osa3DconnexionHotplug();
+
+    osa3DconnexionHotplug::Errno Open();
+    osa3DconnexionHotplug::Errno Close();
+
+    //! File descriptor of the netlink socket (-1 if closed)
+    int GetFileDescriptor() const;
+
+    //! Read the next pending event without blocking
+    /**
+       \return false if there is no pending event
+    */
+    bool ReadEvent( osa3DconnexionHotplug::Event& event );
+
+    //! List the device nodes currently present as ADDED events
+    osa3DconnexionHotplug::Errno Scan( std::vector<osa3DconnexionHotplug::Event>& devices );
+
+};
+
+#endif
@@ -0,0 +1,132 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionLog_h
+#define _osa3DconnexionLog_h
+
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <string>
+#include <cstddef>
+
+//! Binary log of raw device events (record and replay)
+/**
+   The log starts with a 16 bytes header ("SAW3DLOG", version, record size)
+   followed by fixed size records of 40 bytes. Records are only appended so
+   a log cut short by a crash is still readable. For replay, the log is
+   memory mapped and the records are released when they are due according
+   to their timestamps and the replay rate.
+*/
+class CISST_EXPORT osa3DconnexionLog {
+
+ public:
+
+    enum Errno{ ESUCCESS, EFAILURE };
+
+    struct Record{
+
+        //! Interface the event was read from
+        enum Source { JOYSTICK, EVDEV, SPACENAV };
+
+        long long utimestamp;    // device time or monotonic time (us)
+        unsigned short source;   // Source
+        unsigned short type;     // js_event/input_event/spacenavd type
+        unsigned short code;     // axis/button number or evdev code
+        unsigned short aux;      // spacenavd period (ms)
+        int value[6];            // value (axes for spacenavd motion)
+
+    };
+
+    enum { HEADERSIZE = 16 };
+
+ private:
+
+    int fd;                      // log file descriptor
+    bool writing;                // recording or replaying
+    const Record* records;       // mapped records
+    void* map;                   // mapped file
+    size_t mapsize;              // size of the mapped file
+    size_t count;                // number of mapped records
+    size_t cursor;               // next record to replay
+    double rate;                 // replay rate (0 as fast as possible)
+    long long origin;            // timestamp of the record replayed at start
+    double start;                // monotonic time when the cursor was set (s)
+
+ public:
+
+    osa3DconnexionLog();
+    ~osa3DconnexionLog();
+
+    //! Open a log to append records (created if needed)
+    osa3DconnexionLog::Errno Create( const std::string& filename );
+
+    //! Memory map a log to replay it
+    osa3DconnexionLog::Errno Load( const std::string& filename );
+
+    osa3DconnexionLog::Errno Close();
+
+    bool IsRecording() const { return fd != -1 && writing; }
+    bool IsReplaying() const { return map != NULL; }
+
+    //! Append records with a single write
+    osa3DconnexionLog::Errno Write( const osa3DconnexionLog::Record* records,
+                                    size_t count );
+
+    //! Number of records of the replayed log
+    size_t GetSize() const { return count; }
+
+    //! Records of the replayed log
+    const osa3DconnexionLog::Record* GetRecords() const { return records; }
+
+    //! Set the replay rate
+    /**
+       \param rate 1 for real time, N for N times faster and 0 (or
+                   negative) to replay as fast as possible
+    */
+    void SetRate( double rate );
+
+    //! Replay from the given record
+    osa3DconnexionLog::Errno Seek( size_t index );
+
+    //! Replay from the first record at or after the given time
+    /**
+       \param time Seconds since the first record
+    */
+    osa3DconnexionLog::Errno SeekTime( double time );
+
+    //! Index of the next record to replay
+    size_t Tell() const { return cursor; }
+
+    //! Return true once all the records have been replayed
+    bool IsFinished() const { return count <= cursor; }
+
+    //! Seconds until the next record is due (0 if due, negative if finished)
+    double GetDelay() const;
+
+    //! Copy the records that are due and move the cursor
+    /**
+       \return The number of records copied in the buffer
+    */
+    size_t Read( osa3DconnexionLog::Record* records, size_t maxrecords );
+
+    //! Monotonic time in microseconds, used to timestamp records
+    static long long Now();
+
+};
+
+#endif
@@ -0,0 +1,64 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionShm_h
+#define _osa3DconnexionShm_h
+
+#include <saw3Dconnexion/saw3DconnexionShm.h>
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <string>
+
+//! Publisher of the latest sample in a POSIX shared memory segment
+/**
+   The segment layout and the reader are in saw3DconnexionShm.h so
+   processes which don't use cisst can read the samples. Publish only
+   writes memory (no system call) under a seqlock so a single publisher
+   never waits for the readers.
+*/
+class CISST_EXPORT osa3DconnexionShm {
+
+ public:
+
+    enum Errno{ ESUCCESS, EFAILURE };
+
+ private:
+
+    std::string name;                   // name of the segment, i.e. "/saw3Dconnexion"
+    saw3DconnexionShmSegment* segment;  // mapped segment
+    unsigned long long sequence;        // number of samples published
+
+ public:
+
+    osa3DconnexionShm();
+    ~osa3DconnexionShm();
+
+    //! Create (or reuse) and map the segment
+    osa3DconnexionShm::Errno Create( const std::string& name );
+
+    //! Unmap and remove the segment, mapped readers keep the last sample
+    osa3DconnexionShm::Errno Close();
+
+    bool IsOpened() const { return segment != NULL; }
+
+    //! Publish a sample, the sequence and the timestamp are set here
+    void Publish( const saw3DconnexionShmSample& sample );
+
+};
+
+#endif
@@ -0,0 +1,93 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionSpacenav_h
+#define _osa3DconnexionSpacenav_h
+
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <string>
+#include <cstddef>
+
+//! Client for the spacenavd AF_UNIX protocol
+/**
+   Unlike libspnav, each instance owns its own connection to the daemon so
+   several clients can coexist in the same process. The daemon sends
+   packets of 8 integers: the event type (0 motion, 1 press, 2 release)
+   followed by x, y, z, rx, ry, rz and the period for motion events or the
+   button number for button events.
+*/
+class CISST_EXPORT osa3DconnexionSpacenav {
+
+ public:
+
+    enum Errno{ ESUCCESS, EFAILURE };
+
+    struct Event{
+
+        enum Type { MOTION, BUTTON_PRESSED, BUTTON_RELEASED };
+        typedef int Data[6];
+
+        Type type;
+        Data data;           // x, y, z, rx, ry, rz
+        int period;          // time since the previous motion (ms)
+        int button;          // button number
+
+    };
+
+    enum { PACKETSIZE = 8 * sizeof(int) };  // size of a packet on the socket
+    enum { BUFFERSIZE = 64 };               // maximum packets read at once
+
+ private:
+
+    std::string socketname;  // path of the spacenavd socket
+    int fd;                  // socket connected to the daemon
+    char buffer[ BUFFERSIZE * PACKETSIZE ];  // raw packets
+    size_t buffered;         // bytes of a partial packet left in the buffer
+
+ public:
+
+    osa3DconnexionSpacenav();
+    ~osa3DconnexionSpacenav();
+
+    //! Connect to the daemon
+    osa3DconnexionSpacenav::Errno Open( const std::string& socketname = "/var/run/spnav.sock" );
+    osa3DconnexionSpacenav::Errno Close();
+
+    //! Return true if connected to the daemon
+    bool IsOpened() const { return fd != -1; }
+
+    //! Socket file descriptor, i.e. to poll the connection (-1 if closed)
+    int GetFileDescriptor() const { return fd; }
+
+    //! Read all the events queued on the socket
+    /**
+       \param events A buffer of at least maxevents events
+       \param maxevents The size of the buffer (at most BUFFERSIZE are read)
+       \param timeout Time in seconds to wait for the first event. A
+                      negative timeout blocks until an event is available.
+       \return The number of events copied in the buffer. If the daemon
+               closed the connection, the client is closed.
+    */
+    size_t ReadEvents( osa3DconnexionSpacenav::Event* events,
+                       size_t maxevents,
+                       double timeout = 0.0 );
+
+};
+
+#endif
@@ -0,0 +1,153 @@
+/* -*- Mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=cpp softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+#ifndef _osa3DconnexionUdp_h
+#define _osa3DconnexionUdp_h
+
+#include <saw3Dconnexion/saw3DconnexionExport.h>
+#include <string>
+#include <cstddef>
+
+//! Stream of samples in UDP datagrams, one sample per datagram
+/**
+   A sample packet carries the axes, the buttons and the integrated
+   position. While the state doesn't change, the sender only sends short
+   idle packets referring to the last sample packet. All the packets have
+   a sequence number and the source timestamp. Values are little endian:
+
+      0  uint8   magic 'S'
+      1  uint8   version (1)
+      2  uint8   type, 0 sample or 1 idle
+      3  uint8   1 if the device is connected
+      4  uint32  sequence
+      8  int64   source timestamp (us)
+     16  sample: float32 axes[6], uint32 buttons, float64 translation[3]
+                 and float64 orientation[3] (Euler ZYX angles)
+         idle:   uint32 sequence of the last sample packet
+
+   The receiver returns the packets in sequence order and counts the
+   packets lost (gaps in the sequence), reordered (arrived after a later
+   packet, these are dropped) and duplicated. The sequence is reset if
+   the packets keep arriving late, i.e. when the sender is restarted.
+*/
+class CISST_EXPORT osa3DconnexionUdp {
+
+ public:
+
+    enum Errno{ ESUCCESS, EFAILURE };
+
+    struct Packet{
+
+        enum Type { SAMPLE, IDLE };
+
+        Type type;
+        unsigned int sequence;   // set by Send
+        long long utimestamp;    // source time (us)
+        bool connected;
+        unsigned int base;       // idle, sequence of the last sample packet
+        float axis[6];
+        unsigned int buttons;    // bit i for button i
+        double translation[3];
+        double orientation[3];   // Euler ZYX angles
+
+    };
+
+    struct Statistics{
+
+        unsigned long long received;    // valid packets
+        unsigned long long lost;        // sequence numbers never received
+        unsigned long long reordered;   // late packets, not returned
+        unsigned long long duplicated;  // packets received twice, not returned
+        unsigned long long invalid;     // datagrams which are not packets
+
+    };
+
+    enum { SAMPLESIZE = 92 };    // size of a sample packet
+    enum { IDLESIZE = 20 };      // size of an idle packet
+    enum { BUFFERSIZE = 64 };    // maximum packets read at once
+
+ private:
+
+    int fd;                      // UDP socket
+    unsigned int sequence;       // sequence of the next packet sent
+    bool synchronized;           // expected is valid
+    unsigned int expected;       // sequence of the next packet received
+    unsigned long long window;   // bit i set if expected-1-i was received
+    unsigned int late;           // late packets in a row
+    osa3DconnexionUdp::Statistics statistics;
+
+    // resolve "host:port" or "port", returns false if invalid
+    static bool Resolve( const std::string& address, void* addr );
+
+    // update the statistics, return true if the packet is the latest
+    bool Sequence( unsigned int sequence );
+
+ public:
+
+    osa3DconnexionUdp();
+    ~osa3DconnexionUdp();
+
+    //! Send the packets to destination, "host:port"
+    osa3DconnexionUdp::Errno OpenSender( const std::string& destination );
+
+    //! Receive the packets sent to address, "port" or "host:port"
+    osa3DconnexionUdp::Errno OpenReceiver( const std::string& address );
+
+    osa3DconnexionUdp::Errno Close();
+
+    bool IsOpened() const { return fd != -1; }
+
+    //! Socket file descriptor, i.e. to poll the receiver (-1 if closed)
+    int GetFileDescriptor() const { return fd; }
+
+    //! Set the sequence number and send the packet without blocking
+    osa3DconnexionUdp::Errno Send( osa3DconnexionUdp::Packet& packet );
+
+    //! Read all the packets queued on the socket
+    /**
+       \param packets A buffer of at least maxpackets packets
+       \param maxpackets The size of the buffer (at most BUFFERSIZE are read)
+       \param timeout Time in seconds to wait for the first datagram. A
+                      negative timeout blocks until a datagram is available.
+       \return The number of packets copied in the buffer, late and
+               duplicated packets are counted but not returned.
+    */
+    size_t Receive( osa3DconnexionUdp::Packet* packets,
+                    size_t maxpackets,
+                    double timeout = 0.0 );
+
+    const osa3DconnexionUdp::Statistics& GetStatistics() const
+    { return statistics; }
+    void ResetStatistics();
+
+    //! Encode a packet, buffer must hold SAMPLESIZE bytes
+    /**
+       \return The size of the packet
+    */
+    static size_t Encode( const osa3DconnexionUdp::Packet& packet,
+                          unsigned char* buffer );
+
+    //! Decode a packet, return false if the datagram is not a packet
+    static bool Decode( const unsigned char* buffer,
+                        size_t size,
+                        osa3DconnexionUdp::Packet& packet );
+
+};
+
+#endif
@@ -0,0 +1,144 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-    */
+/* ex: set filetype=c softtabstop=4 shiftwidth=4 tabstop=4 cindent expandtab: */
+/*
+
+  Author(s): saw3Dconnexion contributors
+  Created on: 2026-10-16
+
+  (C) Copyright 2026 Johns Hopkins University (JHU), All Rights
+  Reserved.
+
+--- begin cisst license - do not edit ---
+
+This software is provided "as is" under an open source license, with
+no warranty.  The complete license can be found in license.txt and
+http://www.cisst.org/cisst/license.txt.
+
+--- end cisst license ---
+*/
+
+/*
+  Layout of the POSIX shared memory segment published by mts3Dconnexion
+  (see mts3Dconnexion::SetSharedMemory) and header-only reader for
+  processes which don't use cisst, in C or C++.
+
+  The latest sample is protected by a seqlock: the publisher increments
+  the lock before and after writing the sample so the lock is odd while
+  the sample is written.  A reader copies the sample and retries if the
+  lock was odd or changed meanwhile.  Reading doesn't make any system
+  call and never blocks the publisher.
+
+    saw3DconnexionShmReader reader;
+    saw3DconnexionShmSample sample;
+    if (saw3DconnexionShmOpen("/saw3Dconnexion", &reader) == 0) {
+        if (saw3DconnexionShmRead(&reader, &sample) == 0) {
+            ... sample.axis[0] ...
+        }
+        saw3DconnexionShmClose(&reader);
+    }
+
+  Link with -lrt on systems where shm_open is not in the C library.
+*/
+
+#ifndef _saw3DconnexionShm_h
+#define _saw3DconnexionShm_h
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SAW3DCONNEXIONSHM_MAGIC "SAW3DSHM"
+#define SAW3DCONNEXIONSHM_VERSION 1
+/* retries of a read while the publisher writes */
+#define SAW3DCONNEXIONSHM_RETRIES 1000
+
+typedef struct saw3DconnexionShmSample {
+    uint64_t sequence;     /* number of samples published before this one */
+    int64_t utimestamp;    /* CLOCK_MONOTONIC time of publication (us) */
+    double axis[6];        /* robot axes, translations then rotations */
+    uint32_t buttons;      /* bit i set if button i is pressed */
+    uint32_t connected;    /* 1 if the device is connected */
+    double translation[3]; /* integrated position */
+    double rotation[9];    /* integrated orientation, row major */
+} saw3DconnexionShmSample;
+
+typedef struct saw3DconnexionShmSegment {
+    char magic[8];         /* SAW3DCONNEXIONSHM_MAGIC, written last */
+    uint32_t version;      /* SAW3DCONNEXIONSHM_VERSION */
+    uint32_t size;         /* sizeof(saw3DconnexionShmSample) */
+    volatile uint32_t lock;  /* odd while the sample is written */
+    uint32_t reserved;
+    saw3DconnexionShmSample sample;
+} saw3DconnexionShmSegment;
+
+typedef struct saw3DconnexionShmReader {
+    const saw3DconnexionShmSegment * segment;
+} saw3DconnexionShmReader;
+
+/* Map the segment, return 0 on success or -1 if it doesn't exist or has
+   a different layout */
+static inline int saw3DconnexionShmOpen(const char * name, saw3DconnexionShmReader * reader)
+{
+    struct stat st;
+    void * map;
+    int fd;
+    reader->segment = NULL;
+    fd = shm_open(name, O_RDONLY, 0);
+    if (fd == -1) {
+        return -1;
+    }
+    if ((fstat(fd, &st) == -1) || (st.st_size < (off_t)sizeof(saw3DconnexionShmSegment))) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, sizeof(saw3DconnexionShmSegment), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    reader->segment = (const saw3DconnexionShmSegment *)map;
+    __sync_synchronize();
+    if ((memcmp(reader->segment->magic, SAW3DCONNEXIONSHM_MAGIC, 8) != 0)
+        || (reader->segment->version != SAW3DCONNEXIONSHM_VERSION)
+        || (reader->segment->size != sizeof(saw3DconnexionShmSample))) {
+        munmap(map, sizeof(saw3DconnexionShmSegment));
+        reader->segment = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static inline void saw3DconnexionShmClose(saw3DconnexionShmReader * reader)
+{
+    if (reader->segment != NULL) {
+        munmap((void *)reader->segment, sizeof(saw3DconnexionShmSegment));
+        reader->segment = NULL;
+    }
+}
+
+/* Copy a consistent snapshot of the latest sample, return 0 on success or
+   -1 if the publisher kept writing (or stopped while writing) */
+static inline int saw3DconnexionShmRead(const saw3DconnexionShmReader * reader, saw3DconnexionShmSample * sample)
+{
+    int retry;
+    uint32_t before, after;
+    for (retry = 0; retry < SAW3DCONNEXIONSHM_RETRIES; ++retry) {
+        before = reader->segment->lock;
+        __sync_synchronize();
+        if (before & 1) {
+            continue;
+        }
+        memcpy(sample, (const void *)&(reader->segment->sample), sizeof(saw3DconnexionShmSample));
+        __sync_synchronize();
+        after = reader->segment->lock;
+        if (before == after) {
+            return 0;
+        }
+    }
+    return -1;
+}
+
+#endif /* _saw3DconnexionShm_h */